@@ -21,7 +21,8 @@ extern "C" {
 typedef enum {
     HAL_OK = 0,
     HAL_ERR_UNSUPPORTED = -1,
-    HAL_ERR_INVALID = -2
+    HAL_ERR_INVALID = -2,
+    HAL_ERR_BUSY = -3
 } hal_status_t;
 
 typedef enum {
@@ -35,26 +36,176 @@ typedef enum {
     HAL_GPIO_PULL_DOWN
 } hal_gpio_pull_t;
 
+/**
+ * @brief Bitmask of GPIOs, bit n representing GPIO n.
+ */
+typedef uint32_t hal_gpio_mask_t;
+
+/** Mask bit for a GPIO, or 0 for a negative (unused) pin number. */
+#define HAL_GPIO_BIT(pin) (((pin) >= 0 && (pin) < 32) ? ((hal_gpio_mask_t)1U << (pin)) : 0U)
+
+/**
+ * @brief GPIO transitions captured by hal_gpio_edge_enable().
+ */
+typedef enum {
+    HAL_GPIO_EDGE_RISING = 1,
+    HAL_GPIO_EDGE_FALLING = 2,
+    HAL_GPIO_EDGE_BOTH = 3
+} hal_gpio_edge_t;
+
+/**
+ * @brief One GPIO transition captured in the edge ISR.
+ */
+typedef struct {
+    int64_t time_us;        /**< esp_timer timestamp taken on ISR entry. */
+    hal_gpio_level_t level; /**< Pin level sampled in the ISR. */
+} hal_gpio_edge_event_t;
+
+/**
+ * @brief Report of a PWM cut fired from the edge ISR.
+ */
+typedef struct {
+    int64_t edge_us;     /**< Timestamp of the edge that fired the cut. */
+    uint32_t latency_us; /**< Edge timestamp to PWM outputs forced idle. */
+} hal_gpio_edge_cut_t;
+
 typedef void (*hal_timer_callback_t)(void *user_data);
+typedef int64_t (*hal_time_source_t)(void *ctx);
+
+typedef enum {
+    HAL_TIMER_PERIODIC = 0,
+    HAL_TIMER_ONESHOT
+} hal_timer_mode_t;
+
+/**
+ * @brief Selects the execution context of the tick callback.
+ */
+typedef enum {
+    /** Callback runs in the shared esp_timer dispatch task. */
+    HAL_TICK_MODE_TIMER_TASK = 0,
+    /** A GPTimer ISR notifies a dedicated tick task that runs the callback. */
+    HAL_TICK_MODE_TASK,
+    /** Callback runs directly in the GPTimer ISR; it must be ISR-safe. */
+    HAL_TICK_MODE_ISR
+} hal_tick_mode_t;
+
+/**
+ * @brief Tick dispatch configuration for hal_tick_start_ex().
+ */
+typedef struct {
+    hal_tick_mode_t mode;      /**< Dispatch context. */
+    uint32_t task_priority;    /**< Tick task priority (HAL_TICK_MODE_TASK). */
+    uint32_t task_stack_bytes; /**< Tick task stack size (HAL_TICK_MODE_TASK). */
+} hal_tick_config_t;
+
+/** Number of buckets in the tick period-error histogram. */
+#define HAL_TICK_HIST_BUCKETS 8
+
+/**
+ * @brief Upper bounds (inclusive, microseconds) of the period-error buckets.
+ *
+ * Bucket i counts ticks whose absolute period error is at most
+ * hal_tick_hist_limits_us[i] and above the previous limit. The last bucket
+ * is unbounded.
+ */
+extern const uint32_t hal_tick_hist_limits_us[HAL_TICK_HIST_BUCKETS];
+
+/**
+ * @brief Timing statistics gathered on every tick dispatch.
+ *
+ * Period error is the measured start-to-start interval minus the nominal
+ * period: positive values are late ticks, negative values are bunched ticks.
+ */
+typedef struct {
+    uint32_t period_us;            /**< Nominal tick period. */
+    uint32_t ticks;                /**< Callbacks recorded. */
+    uint32_t periods;              /**< Start-to-start intervals recorded. */
+    int32_t period_err_last_us;    /**< Most recent period error. */
+    int32_t period_err_min_us;     /**< Most negative period error (bunching). */
+    int32_t period_err_max_us;     /**< Most positive period error (lateness). */
+    uint32_t period_err_worst_us;  /**< Largest absolute period error. */
+    uint32_t callback_last_us;     /**< Duration of the most recent callback. */
+    uint32_t callback_max_us;      /**< Worst-case callback duration. */
+    uint64_t callback_total_us;    /**< Sum of callback durations. */
+    uint32_t overruns;             /**< Callbacks that took a full period or more. */
+    uint32_t late_ticks;           /**< Intervals that spanned two periods or more. */
+    uint32_t hist[HAL_TICK_HIST_BUCKETS]; /**< Absolute period-error histogram. */
+    uint32_t dispatches;           /**< Callbacks with a measured dispatch latency. */
+    uint32_t latency_last_us;      /**< Most recent timer-ISR-to-callback latency. */
+    uint32_t latency_max_us;       /**< Worst timer-ISR-to-callback latency. */
+    uint64_t latency_total_us;     /**< Sum of dispatch latencies. */
+    int64_t last_start_us;         /**< Start timestamp of the previous callback. */
+    bool has_last_start;           /**< True once last_start_us is valid. */
+} hal_tick_stats_t;
+
+/** Number of PWM channels addressable by a hal_pwm_frame_t. */
+#define HAL_PWM_FRAME_CHANNELS 6
+
+/**
+ * @brief Duties for a set of PWM channels, committed together.
+ */
+typedef struct {
+    uint32_t duty[HAL_PWM_FRAME_CHANNELS]; /**< Duty per channel, in channel resolution units. */
+    uint32_t mask;                         /**< Channels carried by the frame, bit n = channel n. */
+} hal_pwm_frame_t;
+
+/**
+ * @brief Per-channel PWM write accounting.
+ */
+typedef struct {
+    uint32_t requests; /**< Duty requests received through set_duty or a frame. */
+    uint32_t writes;   /**< Requests that changed the duty and reached the LEDC. */
+    uint32_t fades;    /**< Hardware fades started. */
+} hal_pwm_channel_stats_t;
 
 hal_status_t hal_init(void);
 void hal_delay_ms(uint32_t ms);
 
+int64_t hal_time_us(void);
+void hal_time_set_source(hal_time_source_t source, void *ctx);
+
 hal_status_t hal_gpio_config_output(int pin, hal_gpio_level_t initial_level);
 hal_status_t hal_gpio_config_input(int pin, hal_gpio_pull_t pull);
 hal_status_t hal_gpio_write(int pin, hal_gpio_level_t level);
+hal_status_t hal_gpio_write_mask(hal_gpio_mask_t set, hal_gpio_mask_t clear);
 hal_gpio_level_t hal_gpio_read(int pin);
+hal_gpio_mask_t hal_gpio_read_mask(hal_gpio_mask_t mask);
+
+hal_status_t hal_gpio_edge_enable(int pin, hal_gpio_edge_t edges);
+hal_status_t hal_gpio_edge_disable(int pin);
+bool hal_gpio_edge_pop(int pin, hal_gpio_edge_event_t *event);
+uint32_t hal_gpio_edge_dropped(int pin);
+hal_status_t hal_gpio_edge_arm_pwm_cut(int pin, hal_gpio_level_t level, uint32_t channel_mask);
+bool hal_gpio_edge_take_cut(int pin, hal_gpio_edge_cut_t *cut);
+hal_status_t hal_gpio_edge_set_wake(int pin, bool wake);
 
 hal_status_t hal_timer_start(int timer_id, uint32_t period_ms,
                              hal_timer_callback_t callback, void *user_data);
+hal_status_t hal_timer_start_us(int timer_id, uint32_t period_us, hal_timer_mode_t mode,
+                                hal_timer_callback_t callback, void *user_data);
 hal_status_t hal_timer_stop(int timer_id);
 
 hal_status_t hal_tick_start(uint32_t hz, hal_timer_callback_t callback, void *user_data);
+hal_status_t hal_tick_start_ex(uint32_t hz, const hal_tick_config_t *config,
+                               hal_timer_callback_t callback, void *user_data);
 hal_status_t hal_tick_stop(void);
+hal_status_t hal_tick_suspend(void);
+void hal_tick_wake(void);
+hal_status_t hal_tick_get_stats(hal_tick_stats_t *stats);
+void hal_tick_reset_stats(void);
+void hal_tick_stats_init(hal_tick_stats_t *stats, uint32_t period_us);
+void hal_tick_stats_record(hal_tick_stats_t *stats, int64_t start_us, int64_t end_us);
+void hal_tick_stats_record_latency(hal_tick_stats_t *stats, int64_t raised_us, int64_t start_us);
 
 hal_status_t hal_pwm_init(int channel, int pin, uint32_t freq_hz,
                           uint32_t duty_resolution_bits);
 hal_status_t hal_pwm_set_duty(int channel, uint32_t duty);
+hal_status_t hal_pwm_set_duty_pair(int channel_a, uint32_t duty_a,
+                                   int channel_b, uint32_t duty_b);
+hal_status_t hal_pwm_commit(const hal_pwm_frame_t *frame);
+hal_status_t hal_pwm_get_channel_stats(int channel, hal_pwm_channel_stats_t *stats);
+hal_status_t hal_pwm_fade_start(int channel, uint32_t duty, uint32_t time_ms);
+bool hal_pwm_fade_active(int channel);
 
 hal_status_t hal_uart_init(int uart_id, uint32_t baud_rate);
 int hal_uart_write(int uart_id, const uint8_t *data, size_t length);
@@ -41,10 +41,31 @@ extern "C" {
 
 #define HAL_FEED_PIN BOARD_GPIO_UNUSED
 #define HAL_FEED_ACTIVE_LOW 1
+#define HAL_FEED_MIN_US 100
+#define HAL_FEED_LONG_US 11000
+#define HAL_FEED_MAX_US 500000
+#define HAL_FEED_BURST_GAP_US 5000
+
+#define HAL_GPIO_EDGE_SLOTS 4
+#define HAL_GPIO_EDGE_RING_LEN 32
+
+#define HAL_TIMER_MAX 256
+#define HAL_TIMER_WHEEL_SLOTS 256
+#define HAL_TIMER_WHEEL_RES_US 100
+
+#define HAL_TICK_MODE_DEFAULT HAL_TICK_MODE_TASK
+#define HAL_TICK_TASK_PRIORITY 20
+#define HAL_TICK_TASK_STACK_BYTES 4096
 
 #define HAL_PWM_LED_FREQ_HZ 1000
 #define HAL_PWM_MOTOR_FREQ_HZ 20000
 #define HAL_PWM_DUTY_RES_BITS 10
+#define HAL_PWM_FAST_PATH 1
+
+#define HAL_MOTOR_SLOW_DECAY_CRUISE 0
+#define HAL_MOTOR_SLOW_DECAY_APPROACH 1
+
+#define HAL_APP_EVENT_DRIVEN 0
 
 #ifdef __cplusplus
 }
@@ -15,10 +15,282 @@ extern "C" {
 #endif
 
 #include "hal.h"
+#include "pickplaz_brake.h"
+#include "pickplaz_model.h"
+#include "pickplaz_profile.h"
+#include "pickplaz_speed.h"
 
+/** Most feeders one controller can drive. */
+#define PICKPLAZ_APP_FEEDERS_MAX 4
+/** PWM-animated LEDs per feeder. */
+#define PICKPLAZ_APP_FEEDER_LEDS 4
+
+/**
+ * @brief Pins and PWM channels of one feeder.
+ *
+ * @details
+ * Pins set to BOARD_GPIO_UNUSED are not configured and the matching
+ * function is absent. Channels index the shared PWM frame, so no channel
+ * may be used by two feeders; a channel whose pin is unused is ignored.
+ * Feed and opto polarity, the opto ADC thresholds, and the feed pulse
+ * timing are board-wide settings in hal_config.h.
+ */
+typedef struct {
+    int led_pins[PICKPLAZ_APP_FEEDER_LEDS];     /**< Animated status LEDs. */
+    int led_channels[PICKPLAZ_APP_FEEDER_LEDS]; /**< PWM channel per LED. */
+    int feed_led_pin;        /**< Digital feed indicator; LED 3 doubles for it when unused. */
+    int motor_in1_pin;       /**< H-bridge input driven for backward motion. */
+    int motor_in2_pin;       /**< H-bridge input driven for forward motion. */
+    int motor_in1_channel;
+    int motor_in2_channel;
+    int button_forward_pin;
+    int button_backward_pin;
+    bool button_active_low;
+    int feed_pin;            /**< Feed pulse input from the host. */
+    int opto_pin;            /**< Index opto as a digital input. */
+    int opto_adc_channel;    /**< Index opto through the ADC; takes precedence over opto_pin. */
+} pickplaz_feeder_map_t;
+
+/**
+ * @brief Per-feeder share of the control group's execution time.
+ */
+typedef struct {
+    uint32_t runs;     /**< Control passes since init. */
+    uint32_t last_us;  /**< Duration of the most recent pass. */
+    uint32_t max_us;   /**< Worst pass since init. */
+    uint64_t total_us; /**< Sum of pass durations. */
+} pickplaz_app_feeder_stats_t;
+
+/**
+ * @brief Timebase bookkeeping for the application step scheduler.
+ */
+typedef struct {
+    uint32_t steps;              /**< Logic steps executed since init. */
+    uint32_t ticks;              /**< Tick callbacks that advanced the timebase. */
+    uint32_t catchup_ticks;      /**< Ticks that ran more than one step. */
+    uint32_t max_steps_per_tick; /**< Largest number of steps run by one tick. */
+    uint32_t deferred_steps;     /**< Steps carried over because of the per-tick cap. */
+    uint32_t resyncs;            /**< Resynchronizations after a long stall. */
+    uint32_t dropped_steps;      /**< Steps discarded by resynchronization. */
+    uint32_t suspends;           /**< Tick suspensions in event-driven mode. */
+    uint32_t wakeups;            /**< Callbacks that ended a suspension. */
+    uint32_t idle_steps;         /**< Steps skipped while suspended. */
+} pickplaz_app_timing_t;
+
+/**
+ * @brief Tick callback CPU time, split by whether the application was idle.
+ *
+ * @details
+ * Idle is the state in which event-driven mode suspends the tick: nothing
+ * moving, animated through the PWM frame, or waiting on a timed input.
+ * Busy time is measured around the tick callback only, so interrupt and
+ * task switch overhead is not included.
+ */
+typedef struct {
+    bool event_driven;       /**< Event-driven mode is selected. */
+    bool suspended;          /**< The tick is suspended now. */
+    uint64_t idle_us;        /**< Wall time spent idle. */
+    uint64_t idle_busy_us;   /**< Callback time while idle. */
+    uint32_t idle_ppm;       /**< Idle CPU utilisation, parts per million. */
+    uint64_t active_us;      /**< Wall time spent active. */
+    uint64_t active_busy_us; /**< Callback time while active. */
+    uint32_t active_ppm;     /**< Active CPU utilisation, parts per million. */
+    uint32_t events;         /**< Timer and host events consumed. */
+    uint32_t events_dropped; /**< Events lost to a full ring. */
+} pickplaz_app_load_t;
+
+/**
+ * @brief Commands a host can post with pickplaz_app_post_command().
+ */
+typedef enum {
+    PICKPLAZ_APP_CMD_FEED_FORWARD = 0, /**< Feed arg pockets forward. */
+    PICKPLAZ_APP_CMD_FEED_BACKWARD,    /**< Feed arg pockets backward. */
+    PICKPLAZ_APP_CMD_CALIBRATE,        /**< Relearn timing over arg moves each way. */
+} pickplaz_app_command_t;
+
+/**
+ * @brief Execution-time accounting for one scheduler rate group.
+ */
+typedef struct {
+    const char *name;       /**< Group name. */
+    uint32_t rate_hz;       /**< Declared execution rate. */
+    uint32_t phase;         /**< Step offset within the group period. */
+    uint32_t runs;          /**< Executions since init. */
+    uint32_t last_us;       /**< Duration of the most recent execution. */
+    uint32_t max_us;        /**< Worst execution time since init. */
+    uint32_t window_max_us; /**< Worst execution time in the last 1 s window. */
+    uint64_t total_us;      /**< Sum of execution times. */
+} pickplaz_app_group_stats_t;
+
+/**
+ * @brief Dwell statistics for one application FSM state, in control steps.
+ */
+typedef struct {
+    const char *name;    /**< State name. */
+    uint32_t entries;    /**< Times the state was entered. */
+    uint32_t steps;      /**< Steps spent in the state since init. */
+    uint32_t last_steps; /**< Length of the most recent completed visit. */
+    uint32_t max_steps;  /**< Longest completed visit. */
+} pickplaz_app_state_stats_t;
+
+/**
+ * @brief Opto index capture statistics.
+ *
+ * @details
+ * Populated only when the opto is a GPIO with edge capture; intervals are
+ * measured between edge timestamps taken in the ISR.
+ */
+typedef struct {
+    bool edge_capture;            /**< True when opto edges are interrupt-captured. */
+    uint32_t edges;               /**< Transitions consumed from the edge ring. */
+    uint32_t dropped;             /**< Transitions lost to ring overflow. */
+    uint32_t cuts;                /**< Motor drive cuts fired from the edge ISR. */
+    uint32_t cut_latency_last_us; /**< Edge to motor PWM idle, most recent cut. */
+    uint32_t cut_latency_max_us;  /**< Edge to motor PWM idle, worst cut. */
+    uint32_t index_interval_us;   /**< Time between the last two index edges. */
+    uint32_t index_width_us;      /**< Duration of the last index pulse. */
+} pickplaz_app_opto_stats_t;
+
+/**
+ * @brief Feed request queue statistics.
+ */
+typedef struct {
+    uint32_t pending;         /**< Requests waiting now. */
+    uint32_t queued;          /**< Requests accepted since init, merged ones included. */
+    uint32_t coalesced;       /**< Requests merged into the newest waiting one. */
+    uint32_t dropped;         /**< Requests lost to a full queue. */
+    uint32_t flushed;         /**< Requests discarded by a held button. */
+    uint32_t high_water;      /**< Most requests ever waiting. */
+    uint32_t latency_last_us; /**< Queued to taken, most recent request. */
+    uint32_t latency_max_us;  /**< Queued to taken, worst request. */
+} pickplaz_app_queue_stats_t;
+
+/**
+ * @brief Button debouncer statistics.
+ *
+ * @details
+ * Latency runs from the moment an event became decidable (debounce window
+ * or long-press threshold elapsed) to the step that delivered it.
+ */
+typedef struct {
+    bool edge_capture;        /**< True when fed from GPIO edge interrupts. */
+    uint32_t events;          /**< Short, long, and first-hold events delivered. */
+    uint32_t bounces;         /**< Edges that restarted a debounce window. */
+    uint32_t latency_last_us; /**< Most recent event latency. */
+    uint32_t latency_max_us;  /**< Worst event latency. */
+} pickplaz_app_button_stats_t;
+
+/**
+ * @brief Opto-timed speed loop state.
+ */
+typedef struct {
+    bool closed_loop;   /**< True while the cruise duty comes from the controller. */
+    uint32_t duty;      /**< Cruise duty currently applied, STM32 units. */
+    uint32_t gap_us;    /**< Most recent index-to-index gap while driving. */
+    uint32_t samples;   /**< Gaps fed to the controller. */
+    uint32_t fallbacks; /**< Returns to open loop after missing opto edges. */
+} pickplaz_app_speed_stats_t;
+
+/**
+ * @brief Two-speed indexing statistics.
+ *
+ * @details
+ * gain_us is the mean time saved per pocket by cruising fast and creeping
+ * only near the predicted index, against creeping the whole way.
+ */
+typedef struct {
+    bool approaching;      /**< The creep duty is in force now. */
+    uint32_t moves;        /**< Index-to-index moves timed since the profile was set. */
+    uint32_t last_us;      /**< Duration of the most recent one. */
+    uint32_t avg_us;       /**< Mean duration. */
+    uint32_t creep_avg_us; /**< Mean estimated duration at the approach duty throughout. */
+    int32_t gain_us;       /**< creep_avg_us - avg_us. */
+} pickplaz_app_profile_stats_t;
+
+/**
+ * @brief Learned duration of one half of an increment.
+ */
+typedef struct {
+    uint32_t samples;    /**< Moves timed since the model was reset. */
+    uint32_t mean_us;    /**< Mean duration. */
+    uint32_t sigma_us;   /**< Standard deviation. */
+    uint32_t timeout_us; /**< Timeout in force, the fixed one until the model is ready. */
+} pickplaz_app_phase_model_t;
+
+/**
+ * @brief Learned timing of one feed direction.
+ */
+typedef struct {
+    bool calibrating;                  /**< A calibration run is in progress. */
+    uint32_t timeouts;                 /**< Increments ended by a timeout, both directions. */
+    pickplaz_app_phase_model_t leave;  /**< Start of a move until the opto leaves the index. */
+    pickplaz_app_phase_model_t travel; /**< Leaving the index until the next one. */
+} pickplaz_app_model_stats_t;
+
+/**
+ * @brief Motor drive phases that can use different decay modes.
+ */
+typedef enum {
+    PICKPLAZ_APP_PHASE_CRUISE = 0, /**< Start, ramp, and cruise duty. */
+    PICKPLAZ_APP_PHASE_APPROACH,   /**< Approach duty before the index. */
+    PICKPLAZ_APP_PHASE_COUNT
+} pickplaz_app_phase_t;
+
+/**
+ * @brief Current decay between PWM pulses of the H-bridge.
+ */
+typedef enum {
+    PICKPLAZ_APP_DECAY_FAST = 0, /**< Coast: the undriven input is held low. */
+    PICKPLAZ_APP_DECAY_SLOW,     /**< Brake: driven input high, other input inverted PWM. */
+} pickplaz_app_decay_t;
+
+/**
+ * @brief Brake planner state and learned deceleration model.
+ */
+typedef struct {
+    pickplaz_brake_mode_t mode; /**< Active brake mode. */
+    uint32_t last_duty;         /**< Duty of the most recent brake, STM32 units. */
+    uint32_t last_ticks;        /**< Length of the most recent brake. */
+    uint32_t plug_decel;        /**< Learned plug deceleration. */
+    uint32_t short_decel;       /**< Learned short-brake deceleration. */
+    uint32_t stops;             /**< Adaptive stops that held the index. */
+    uint32_t reversals;         /**< Adaptive stops where the brake pushed the tape back out. */
+    uint32_t overshoots;        /**< Adaptive stops where the tape coasted through. */
+} pickplaz_app_brake_stats_t;
+
+hal_status_t pickplaz_app_configure(const pickplaz_feeder_map_t *maps, size_t count);
 hal_status_t pickplaz_app_init(void);
 hal_status_t pickplaz_app_start(void);
 void pickplaz_app_stop(void);
+size_t pickplaz_app_feeder_count(void);
+hal_status_t pickplaz_app_set_profile(size_t feeder, const pickplaz_profile_config_t *config);
+hal_status_t pickplaz_app_set_speed(size_t feeder, const pickplaz_speed_config_t *config);
+hal_status_t pickplaz_app_set_brake(size_t feeder, const pickplaz_brake_config_t *config);
+hal_status_t pickplaz_app_set_model(size_t feeder, const pickplaz_model_config_t *config);
+hal_status_t pickplaz_app_set_decay(size_t feeder, pickplaz_app_phase_t phase,
+                                    pickplaz_app_decay_t decay);
+void pickplaz_app_set_event_driven(bool enable);
+hal_status_t pickplaz_app_post_command(size_t feeder, pickplaz_app_command_t command,
+                                       uint16_t arg);
+uint32_t pickplaz_app_advance(int64_t now_us);
+void pickplaz_app_get_timing(pickplaz_app_timing_t *timing);
+hal_status_t pickplaz_app_get_feeder_stats(size_t feeder, pickplaz_app_feeder_stats_t *stats);
+hal_status_t pickplaz_app_get_queue_stats(size_t feeder, pickplaz_app_queue_stats_t *stats);
+hal_status_t pickplaz_app_get_opto_stats(size_t feeder, pickplaz_app_opto_stats_t *stats);
+hal_status_t pickplaz_app_get_profile_stats(size_t feeder, pickplaz_app_profile_stats_t *stats);
+hal_status_t pickplaz_app_get_model_stats(size_t feeder, bool forward,
+                                          pickplaz_app_model_stats_t *stats);
+hal_status_t pickplaz_app_get_speed_stats(size_t feeder, pickplaz_app_speed_stats_t *stats);
+hal_status_t pickplaz_app_get_brake_stats(size_t feeder, pickplaz_app_brake_stats_t *stats);
+void pickplaz_app_get_load(pickplaz_app_load_t *load);
+hal_status_t pickplaz_app_get_button_stats(size_t feeder, size_t index,
+                                           pickplaz_app_button_stats_t *stats);
+size_t pickplaz_app_group_count(void);
+hal_status_t pickplaz_app_get_group_stats(size_t index, pickplaz_app_group_stats_t *stats);
+size_t pickplaz_app_state_count(void);
+hal_status_t pickplaz_app_get_state_stats(size_t feeder, size_t index,
+                                          pickplaz_app_state_stats_t *stats);
+void pickplaz_app_selftest_run(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,87 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_BRAKE_H_
+#define PICKPLAZ_BRAKE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief How the motor is stopped.
+ */
+typedef enum {
+    PICKPLAZ_BRAKE_FIXED = 0, /**< Reverse at the last driven duty for fixed_ticks. */
+    PICKPLAZ_BRAKE_PLUG,      /**< Reverse with duty and length from speed and the model. */
+    PICKPLAZ_BRAKE_SHORT,     /**< Both bridge inputs high, length from speed and the model. */
+} pickplaz_brake_mode_t;
+
+/**
+ * @brief Brake tuning; duties in STM32 units (0..2048), lengths in control ticks.
+ *
+ * @details
+ * Speeds are in thousandths of an index gap per second (1e9 / gap_us).
+ * Decelerations are the speed removed per tick: at full duty for a plug
+ * brake, and with the windings shorted for a short brake.
+ */
+typedef struct {
+    pickplaz_brake_mode_t mode;
+    uint32_t fixed_ticks;    /**< Brake length in FIXED mode and when the speed is unknown. */
+    uint32_t target_ticks;   /**< PLUG: brake length the duty is chosen for. */
+    uint32_t min_duty;       /**< PLUG: lowest reverse duty. */
+    uint32_t max_duty;       /**< PLUG: highest reverse duty. */
+    uint32_t max_ticks;      /**< Longest adaptive brake. */
+    uint32_t plug_decel;     /**< Initial plug deceleration at full duty. */
+    uint32_t short_decel;    /**< Initial short-brake deceleration. */
+    uint32_t settle_ticks;   /**< Ticks after release watched for the tape leaving the index. */
+    uint32_t index_permille; /**< Share of the pocket pitch covered by the index window. */
+} pickplaz_brake_config_t;
+
+/**
+ * @brief One brake to apply.
+ */
+typedef struct {
+    bool shorted;   /**< True to drive both inputs at duty instead of reversing. */
+    uint32_t duty;  /**< Brake duty, STM32 units. */
+    uint32_t ticks; /**< Control ticks to hold the brake. */
+} pickplaz_brake_plan_t;
+
+/**
+ * @brief Brake planner and learned deceleration model.
+ */
+typedef struct {
+    pickplaz_brake_config_t config;
+    uint32_t tick_hz;      /**< Rate of pickplaz_brake_observe() calls. */
+    uint32_t plug_decel;   /**< Learned plug deceleration. */
+    uint32_t short_decel;  /**< Learned short-brake deceleration. */
+    pickplaz_brake_plan_t plan;
+    bool watching;         /**< An adaptive stop on index is being watched. */
+    uint32_t elapsed;      /**< Ticks since the watched brake started. */
+    uint32_t pass_ticks;   /**< Earliest tick the tape could coast out of the far side. */
+    uint32_t stops;        /**< Watched stops that held the index. */
+    uint32_t reversals;    /**< Index lost before the tape could have crossed the window. */
+    uint32_t overshoots;   /**< Index lost through the far side of the window. */
+} pickplaz_brake_t;
+
+void pickplaz_brake_init(pickplaz_brake_t *brake, const pickplaz_brake_config_t *config,
+                         uint32_t tick_hz);
+pickplaz_brake_plan_t pickplaz_brake_plan(pickplaz_brake_t *brake, uint32_t last_duty,
+                                          uint32_t gap_us, bool indexed);
+void pickplaz_brake_observe(pickplaz_brake_t *brake, bool indexed, bool commanded);
+bool pickplaz_brake_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
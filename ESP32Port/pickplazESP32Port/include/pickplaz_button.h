@@ -0,0 +1,70 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_BUTTON_H_
+#define PICKPLAZ_BUTTON_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Debounced button event.
+ */
+typedef enum {
+    /** No event. */
+    PICKPLAZ_BUTTON_NONE = 0,
+    /** Released before the long-press threshold. */
+    PICKPLAZ_BUTTON_SHORT,
+    /** Released after the long-press threshold. */
+    PICKPLAZ_BUTTON_LONG,
+    /** Held beyond the long-press threshold; reported on every poll. */
+    PICKPLAZ_BUTTON_HOLD
+} pickplaz_button_event_t;
+
+/**
+ * @brief Debounce windows and press thresholds, in microseconds.
+ */
+typedef struct {
+    uint32_t attack_us;  /**< Input must stay active this long to accept a press. */
+    uint32_t release_us; /**< Input must stay inactive this long to accept a release. */
+    uint32_t long_us;    /**< Presses held longer than this are long/hold. */
+} pickplaz_button_config_t;
+
+/**
+ * @brief Timestamp-driven debouncer state for one button.
+ */
+typedef struct {
+    pickplaz_button_config_t config;
+    bool raw;                 /**< Input level after the most recent edge. */
+    int64_t raw_us;           /**< Timestamp of the most recent edge. */
+    bool pressed;             /**< Debounced state. */
+    int64_t press_us;         /**< Edge that started the accepted press. */
+    bool holding;             /**< Hold threshold has been reported. */
+    uint32_t events;          /**< Events returned by pickplaz_button_poll(). */
+    uint32_t bounces;         /**< Edges that restarted an unsettled window. */
+    uint32_t latency_last_us; /**< Deciding edge to event, most recent event. */
+    uint32_t latency_max_us;  /**< Deciding edge to event, worst event. */
+} pickplaz_button_t;
+
+void pickplaz_button_init(pickplaz_button_t *button, const pickplaz_button_config_t *config,
+                          bool active, int64_t now_us);
+void pickplaz_button_edge(pickplaz_button_t *button, bool active, int64_t time_us);
+bool pickplaz_button_busy(const pickplaz_button_t *button);
+pickplaz_button_event_t pickplaz_button_poll(pickplaz_button_t *button, int64_t now_us);
+bool pickplaz_button_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
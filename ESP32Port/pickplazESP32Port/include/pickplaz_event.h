@@ -0,0 +1,63 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_EVENT_H_
+#define PICKPLAZ_EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Slots per ring; a power of two. */
+#define PICKPLAZ_EVENT_RING_LEN 16
+
+/**
+ * @brief Kind of an application event.
+ */
+typedef enum {
+    PICKPLAZ_EVENT_NONE = 0,
+    PICKPLAZ_EVENT_TIMER,   /**< A timer expired; source is the timer id. */
+    PICKPLAZ_EVENT_COMMAND, /**< A host command; source is the command, arg its parameter. */
+} pickplaz_event_type_t;
+
+/**
+ * @brief Compact event posted to the application.
+ */
+typedef struct {
+    uint8_t type;   /**< pickplaz_event_type_t. */
+    uint8_t source; /**< Timer id or command. */
+    uint8_t target; /**< Feeder a command is for. */
+    uint16_t arg;   /**< Type-specific parameter. */
+} pickplaz_event_t;
+
+/**
+ * @brief Lock-free single-producer/single-consumer event ring.
+ */
+typedef struct {
+    uint32_t head;       /**< Advanced by the producer only. */
+    uint32_t tail;       /**< Advanced by the consumer only. */
+    uint32_t dropped;    /**< Posts refused because the ring was full; producer-owned. */
+    uint32_t high_water; /**< Most events ever pending; producer-owned. */
+    pickplaz_event_t slots[PICKPLAZ_EVENT_RING_LEN];
+} pickplaz_event_ring_t;
+
+void pickplaz_event_init(pickplaz_event_ring_t *ring);
+bool pickplaz_event_post(pickplaz_event_ring_t *ring, const pickplaz_event_t *event);
+bool pickplaz_event_take(pickplaz_event_ring_t *ring, pickplaz_event_t *event);
+uint32_t pickplaz_event_pending(const pickplaz_event_ring_t *ring);
+bool pickplaz_event_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_FEED_H_
+#define PICKPLAZ_FEED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Feed pulse thresholds, in microseconds.
+ */
+typedef struct {
+    uint32_t min_us;  /**< Pulses shorter than this are glitches and ignored. */
+    uint32_t long_us; /**< Pulses at least this wide are long (backward). */
+    uint32_t max_us;  /**< Pulses wider than this are invalid and abort the burst. */
+    uint32_t gap_us;  /**< Idle time that ends a burst; 0 reports every pulse alone. */
+} pickplaz_feed_config_t;
+
+/**
+ * @brief Feed command decoded from one burst of pulses.
+ */
+typedef struct {
+    bool forward;      /**< Short pulses feed forward, long pulses backward. */
+    uint32_t pockets;  /**< Number of pulses in the burst. */
+    uint32_t width_us; /**< Width of the last pulse in the burst. */
+    int64_t end_us;    /**< Falling edge of the last pulse. */
+} pickplaz_feed_cmd_t;
+
+/**
+ * @brief Pulse-width decoder state for the feed input.
+ */
+typedef struct {
+    pickplaz_feed_config_t config;
+    bool level;          /**< Input level after the most recent edge. */
+    int64_t rise_us;     /**< Rising edge of the pulse in progress. */
+    int64_t fall_us;     /**< Falling edge of the last accepted pulse. */
+    bool in_burst;       /**< At least one pulse is waiting for the burst gap. */
+    bool burst_forward;  /**< Direction of the first pulse in the burst. */
+    bool burst_mixed;    /**< Burst mixed short and long pulses. */
+    uint32_t pulses;     /**< Pulses accepted in the current burst. */
+    uint32_t width_us;   /**< Width of the last accepted pulse. */
+    uint32_t commands;   /**< Commands returned by pickplaz_feed_poll(). */
+    uint32_t glitches;   /**< Pulses rejected as shorter than min_us. */
+    uint32_t rejected;   /**< Bursts discarded as mixed or over-long. */
+} pickplaz_feed_decoder_t;
+
+void pickplaz_feed_init(pickplaz_feed_decoder_t *decoder, const pickplaz_feed_config_t *config,
+                        bool active, int64_t now_us);
+void pickplaz_feed_edge(pickplaz_feed_decoder_t *decoder, bool active, int64_t time_us);
+bool pickplaz_feed_busy(const pickplaz_feed_decoder_t *decoder);
+bool pickplaz_feed_poll(pickplaz_feed_decoder_t *decoder, int64_t now_us,
+                        pickplaz_feed_cmd_t *cmd);
+bool pickplaz_feed_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_FSM_H_
+#define PICKPLAZ_FSM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef bool (*pickplaz_fsm_guard_t)(void *ctx);
+typedef void (*pickplaz_fsm_action_t)(void *ctx);
+
+/**
+ * @brief One guarded transition out of a state.
+ */
+typedef struct {
+    pickplaz_fsm_guard_t guard;   /**< Condition to take the transition; NULL always fires. */
+    pickplaz_fsm_action_t action; /**< Run between the exit and entry hooks; may be NULL. */
+    uint8_t target;               /**< Index of the destination state. */
+    uint16_t timer;               /**< Timer loaded on entry; 0 uses the target's timeout. */
+} pickplaz_fsm_transition_t;
+
+/**
+ * @brief One state of a table-driven FSM.
+ *
+ * @details
+ * Each step runs dwell, then the first transition whose guard holds. With
+ * no transition taken, a state with a timeout counts its timer down and
+ * takes on_timeout the step after it reaches zero.
+ */
+typedef struct {
+    const char *name;
+    pickplaz_fsm_action_t entry;  /**< Run on entering the state; may be NULL. */
+    pickplaz_fsm_action_t exit;   /**< Run on leaving the state; may be NULL. */
+    pickplaz_fsm_action_t dwell;  /**< Run every step in the state; may be NULL. */
+    const pickplaz_fsm_transition_t *transitions; /**< Checked in order. */
+    uint8_t transition_count;
+    uint16_t timeout;             /**< Steps before on_timeout; 0 disables the timer. */
+    pickplaz_fsm_transition_t on_timeout;
+} pickplaz_fsm_state_t;
+
+/**
+ * @brief Dwell-time statistics for one state, in steps.
+ */
+typedef struct {
+    uint32_t entries;  /**< Times the state was entered. */
+    uint32_t steps;    /**< Steps spent in the state. */
+    uint32_t last;     /**< Length of the most recent completed visit. */
+    uint32_t max;      /**< Longest completed visit. */
+} pickplaz_fsm_stats_t;
+
+/**
+ * @brief Running instance of a state table.
+ */
+typedef struct {
+    const pickplaz_fsm_state_t *states;
+    uint8_t count;
+    uint8_t initial;
+    uint8_t state;
+    uint16_t timer;
+    uint32_t dwell;               /**< Steps spent in the current visit. */
+    pickplaz_fsm_stats_t *stats;  /**< count entries, or NULL. */
+    void *ctx;                    /**< Passed to every guard and action. */
+} pickplaz_fsm_t;
+
+void pickplaz_fsm_init(pickplaz_fsm_t *fsm, const pickplaz_fsm_state_t *states, uint8_t count,
+                       uint8_t initial, pickplaz_fsm_stats_t *stats, void *ctx);
+void pickplaz_fsm_step(pickplaz_fsm_t *fsm);
+bool pickplaz_fsm_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_MODEL_H_
+#define PICKPLAZ_MODEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Tuning of a learned timing model.
+ */
+typedef struct {
+    uint32_t sigma_k;     /**< Standard deviations of headroom in a timeout. */
+    uint32_t margin;      /**< Fixed headroom added to a timeout, in steps. */
+    uint32_t ema_shift;   /**< Online update weight is 1 / 2^ema_shift. */
+    uint32_t min_samples; /**< Samples before the model replaces the fixed timeout. */
+} pickplaz_model_config_t;
+
+/**
+ * @brief Mean and variance of one measured duration, in steps.
+ *
+ * @details
+ * The mean is Q8 and the variance Q16. m2_q is Welford's running sum of
+ * squared deviations and is only meaningful while the model is exact.
+ */
+typedef struct {
+    uint32_t samples; /**< Durations sampled since reset. */
+    int32_t mean_q;   /**< Mean, Q8 steps. */
+    int64_t m2_q;     /**< Welford sum of squared deviations, Q16. */
+    int64_t var_q;    /**< Variance, Q16 steps squared. */
+} pickplaz_model_t;
+
+void pickplaz_model_reset(pickplaz_model_t *model);
+void pickplaz_model_sample(pickplaz_model_t *model, const pickplaz_model_config_t *config,
+                           uint32_t steps, bool exact);
+uint32_t pickplaz_model_mean(const pickplaz_model_t *model);
+uint32_t pickplaz_model_sigma(const pickplaz_model_t *model);
+bool pickplaz_model_ready(const pickplaz_model_t *model, const pickplaz_model_config_t *config);
+uint32_t pickplaz_model_timeout(const pickplaz_model_t *model,
+                                const pickplaz_model_config_t *config, uint32_t fallback);
+bool pickplaz_model_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_PROFILE_H_
+#define PICKPLAZ_PROFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief How the approach phase is placed within a move.
+ */
+typedef enum {
+    /** Commanded duty summed over the move, a proxy for distance. */
+    PICKPLAZ_PROFILE_PREDICT_PROGRESS = 0,
+    /** Ticks since the move started. */
+    PICKPLAZ_PROFILE_PREDICT_TIME,
+} pickplaz_profile_predictor_t;
+
+/**
+ * @brief Motion profile limits, in STM32 duty units (0..2048).
+ */
+typedef struct {
+    uint32_t cruise_duty;       /**< Duty magnitude while cruising. */
+    uint32_t approach_duty;     /**< Duty magnitude during the approach to the index. */
+    uint32_t start_duty;        /**< Duty applied at once from rest to break static friction. */
+    uint32_t accel;             /**< Duty slew limit per second; 0 removes the limit. */
+    uint32_t jerk;              /**< Slew change limit per second squared; 0 gives a trapezoid. */
+    uint32_t approach_permille; /**< Final share of the learned move run at approach duty. */
+    /** Measure the approach share is taken of. */
+    pickplaz_profile_predictor_t predictor;
+} pickplaz_profile_config_t;
+
+/**
+ * @brief Per-tick motion profile state.
+ *
+ * @details
+ * Duty and slew are Q16 fixed point. progress integrates the commanded duty
+ * over the current move as a position proxy; learned and learned_ticks hold
+ * the progress and duration of the last completed move, and the configured
+ * predictor uses one of them to place the approach phase of the next one.
+ */
+typedef struct {
+    pickplaz_profile_config_t config;
+    int32_t accel_q;        /**< Slew limit, Q16 duty per tick. */
+    int32_t jerk_q;         /**< Slew change limit, Q16 duty per tick per tick. */
+    int32_t duty_q;         /**< Commanded duty magnitude, Q16. */
+    int32_t slew_q;         /**< Current duty change per tick, Q16. */
+    int8_t dir;             /**< Direction of the current motion: 1, -1, or 0 at rest. */
+    bool in_move;           /**< A move is being tracked for the approach phase. */
+    bool approach;          /**< The tracked move stops on its index and gets an approach phase. */
+    bool approaching;       /**< The approach limit is in force. */
+    uint32_t progress;      /**< Sum of duty over the ticks of the current move. */
+    uint32_t learned;       /**< Progress of the last completed move; 0 when unknown. */
+    uint32_t ticks;         /**< Ticks of the current move. */
+    uint32_t learned_ticks; /**< Ticks of the last completed move; 0 when unknown. */
+    uint32_t moves;         /**< Completed moves that were learned. */
+    uint64_t move_ticks;    /**< Sum of the durations of those moves. */
+    uint64_t creep_ticks;   /**< Their estimated sum at approach duty throughout. */
+} pickplaz_profile_t;
+
+void pickplaz_profile_init(pickplaz_profile_t *profile, const pickplaz_profile_config_t *config,
+                           uint32_t tick_hz);
+int32_t pickplaz_profile_step(pickplaz_profile_t *profile, int32_t target);
+void pickplaz_profile_move_begin(pickplaz_profile_t *profile, bool approach);
+void pickplaz_profile_expect(pickplaz_profile_t *profile, uint32_t ticks);
+void pickplaz_profile_move_end(pickplaz_profile_t *profile, bool learn);
+bool pickplaz_profile_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
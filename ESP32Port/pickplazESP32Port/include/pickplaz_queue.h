@@ -0,0 +1,58 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_QUEUE_H_
+#define PICKPLAZ_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Requests one queue holds after coalescing. */
+#define PICKPLAZ_QUEUE_LEN 8
+
+/**
+ * @brief One queued feed request.
+ */
+typedef struct {
+    bool forward;     /**< Feed direction. */
+    uint16_t pockets; /**< Pockets to feed, at least 1. */
+    int64_t time_us;  /**< When the oldest request merged into this one was queued. */
+} pickplaz_queue_req_t;
+
+/**
+ * @brief Bounded FIFO of feed requests.
+ */
+typedef struct {
+    uint8_t head;          /**< Slot of the oldest request. */
+    uint8_t count;         /**< Requests queued. */
+    uint32_t queued;       /**< Requests accepted, merged or not. */
+    uint32_t coalesced;    /**< Requests merged into the newest queued one. */
+    uint32_t dropped;      /**< Requests refused because the queue was full. */
+    uint32_t flushed;      /**< Requests discarded by pickplaz_queue_flush(). */
+    uint32_t high_water;   /**< Most requests ever queued. */
+    pickplaz_queue_req_t slots[PICKPLAZ_QUEUE_LEN];
+} pickplaz_queue_t;
+
+void pickplaz_queue_init(pickplaz_queue_t *queue);
+bool pickplaz_queue_push(pickplaz_queue_t *queue, bool forward, uint16_t pockets,
+                         int64_t now_us);
+const pickplaz_queue_req_t *pickplaz_queue_peek(const pickplaz_queue_t *queue);
+bool pickplaz_queue_pop(pickplaz_queue_t *queue, pickplaz_queue_req_t *req);
+void pickplaz_queue_flush(pickplaz_queue_t *queue);
+bool pickplaz_queue_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
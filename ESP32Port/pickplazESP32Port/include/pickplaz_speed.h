@@ -0,0 +1,61 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+#ifndef PICKPLAZ_SPEED_H_
+#define PICKPLAZ_SPEED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Speed loop tuning; duties in STM32 units (0..2048).
+ */
+typedef struct {
+    uint32_t setpoint_us; /**< Target gap time, index exit to next index; 0 disables the loop. */
+    uint32_t kp;          /**< Proportional duty per 100% gap error. */
+    uint32_t ki;          /**< Integral duty added per sample per 100% gap error. */
+    uint32_t min_duty;    /**< Lowest cruise duty the loop may command. */
+    uint32_t max_duty;    /**< Highest cruise duty the loop may command. */
+    uint32_t open_duty;   /**< Open-loop cruise duty, also the loop's feedforward. */
+    uint32_t timeout_us;  /**< Gap after which edges count as missing. */
+} pickplaz_speed_config_t;
+
+/**
+ * @brief Opto-timed speed estimator and PI controller state.
+ */
+typedef struct {
+    pickplaz_speed_config_t config;
+    bool driving;        /**< Motor seen driving by the last check. */
+    bool armed;          /**< Index exit seen while driving; waiting for the next index. */
+    int64_t exit_us;     /**< Timestamp of the index exit. */
+    int64_t edge_us;     /**< Last edge, or drive start, while driving. */
+    bool closed;         /**< Output comes from the controller rather than open_duty. */
+    int32_t integ;       /**< Integral term, duty units. */
+    uint32_t duty;       /**< Cruise duty to command. */
+    uint32_t gap_us;     /**< Most recent measured gap. */
+    int64_t arrive_us;   /**< Index arrival that completed gap_us. */
+    uint32_t samples;    /**< Gaps fed to the controller. */
+    uint32_t fallbacks;  /**< Returns to open loop after missing edges. */
+} pickplaz_speed_t;
+
+void pickplaz_speed_init(pickplaz_speed_t *speed, const pickplaz_speed_config_t *config);
+void pickplaz_speed_edge(pickplaz_speed_t *speed, bool indexed, int64_t time_us, bool driving);
+void pickplaz_speed_check(pickplaz_speed_t *speed, int64_t now_us, bool driving);
+uint32_t pickplaz_speed_duty(const pickplaz_speed_t *speed);
+bool pickplaz_speed_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
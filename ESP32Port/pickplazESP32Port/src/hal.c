@@ -24,17 +24,24 @@
 
 #include "hal_config.h"
 
+#include "esp_attr.h"
+#include "esp_cpu.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 
 #include "driver/gpio.h"
+#include "driver/gptimer.h"
 #include "driver/i2c.h"
 #include "driver/ledc.h"
 #include "driver/spi_master.h"
 #include "driver/uart.h"
 #include "esp_adc/adc_oneshot.h"
 
+#include "hal/ledc_ll.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -48,23 +55,30 @@ static bool hal_gpio_output_valid(int pin) {
     return (pin >= 0) && GPIO_IS_VALID_OUTPUT_GPIO((gpio_num_t)pin);
 }
 
+static hal_status_t hal_timer_wheel_init(void);
+static void hal_pwm_cut_isr(int channel);
+static void hal_pwm_cut_release(uint32_t channel_mask);
+static void hal_tick_wake_isr(void);
+
 /**
  * @brief Initializes HAL services.
  *
  * @details
- * Performs lightweight HAL startup and logs the initialization banner.
+ * Performs lightweight HAL startup, prepares the software timer wheel, and
+ * logs the initialization banner.
  *
  * Postconditions:
  * - HAL services are available to callers.
  *
  * Side effects:
  * - Writes a log message.
+ * - Creates the esp_timer that backs all HAL timers.
  *
- * @return HAL_OK on success.
+ * @return HAL_OK on success, HAL_ERR_INVALID if the timer wheel cannot start.
  */
 hal_status_t hal_init(void) {
     ESP_LOGI(TAG, "HAL init (Stage 3)");
-    return HAL_OK;
+    return hal_timer_wheel_init();
 }
 
 /**
@@ -88,6 +102,44 @@ void hal_delay_ms(uint32_t ms) {
     vTaskDelay(pdMS_TO_TICKS(ms));
 }
 
+static hal_time_source_t hal_time_source;
+static void *hal_time_source_ctx;
+
+/**
+ * @brief Returns the absolute HAL timebase in microseconds.
+ *
+ * @details
+ * Backed by esp_timer_get_time(), which is monotonic from boot and does not
+ * wrap in practice. A simulated clock installed with hal_time_set_source()
+ * takes precedence so timing logic can be exercised deterministically.
+ *
+ * @return Microseconds since boot (or since the simulated epoch).
+ */
+int64_t hal_time_us(void) {
+    if (hal_time_source) {
+        return hal_time_source(hal_time_source_ctx);
+    }
+    return esp_timer_get_time();
+}
+
+/**
+ * @brief Overrides the HAL timebase with a custom clock.
+ *
+ * @details
+ * Intended for self-tests and host simulation. Passing NULL restores the
+ * esp_timer-backed clock.
+ *
+ * Side effects:
+ * - All subsequent hal_time_us() calls use the new source.
+ *
+ * @param source Clock function returning microseconds, or NULL.
+ * @param ctx Opaque pointer passed to source.
+ */
+void hal_time_set_source(hal_time_source_t source, void *ctx) {
+    hal_time_source_ctx = ctx;
+    hal_time_source = source;
+}
+
 /**
  * @brief Configures a GPIO pin as a push-pull output.
  *
@@ -185,6 +237,44 @@ hal_status_t hal_gpio_write(int pin, hal_gpio_level_t level) {
     return HAL_OK;
 }
 
+/**
+ * @brief Drives several GPIO outputs high and low with set/clear registers.
+ *
+ * @details
+ * All pins in set change in one GPIO_OUT_W1TS_REG write and all pins in
+ * clear in one GPIO_OUT_W1TC_REG write, so pins in the same group never
+ * glitch relative to each other and other outputs are untouched without a
+ * read-modify-write. Set pins are applied one bus write before cleared pins.
+ * An empty group costs no register write.
+ *
+ * Preconditions:
+ * - Pins in set and clear are configured as GPIO outputs.
+ *
+ * Side effects:
+ * - Updates GPIO output levels.
+ *
+ * Error handling:
+ * - Returns HAL_ERR_INVALID without writing if a pin appears in both masks
+ *   or is not output-capable.
+ *
+ * @param set Pins to drive high.
+ * @param clear Pins to drive low.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid masks.
+ */
+hal_status_t hal_gpio_write_mask(hal_gpio_mask_t set, hal_gpio_mask_t clear) {
+    if ((set & clear) != 0 ||
+        ((set | clear) & ~(hal_gpio_mask_t)SOC_GPIO_VALID_OUTPUT_GPIO_MASK) != 0) {
+        return HAL_ERR_INVALID;
+    }
+    if (set != 0) {
+        REG_WRITE(GPIO_OUT_W1TS_REG, set);
+    }
+    if (clear != 0) {
+        REG_WRITE(GPIO_OUT_W1TC_REG, clear);
+    }
+    return HAL_OK;
+}
+
 /**
  * @brief Reads the current logic level of a GPIO.
  *
@@ -202,94 +292,667 @@ hal_gpio_level_t hal_gpio_read(int pin) {
 }
 
 /**
- * @brief Defines the maximum number of HAL timer slots.
+ * @brief Samples several GPIO input levels in a single register read.
+ *
+ * @details
+ * Reads GPIO_IN_REG once so every requested pin is sampled at the same
+ * instant, and returns the raw levels restricted to mask. Bits for pins that
+ * do not exist on this SoC always read as 0. No per-pin validation is done,
+ * so callers should build the mask once (e.g. with HAL_GPIO_BIT()) rather
+ * than per sample.
+ *
+ * Preconditions:
+ * - Pins in mask are configured as inputs for the levels to be meaningful.
+ *
+ * @param mask Pins to sample.
+ * @return Raw logic levels, bit n set when GPIO n reads high.
+ */
+hal_gpio_mask_t hal_gpio_read_mask(hal_gpio_mask_t mask) {
+    return (hal_gpio_mask_t)REG_READ(GPIO_IN_REG) & mask &
+           (hal_gpio_mask_t)SOC_GPIO_VALID_GPIO_MASK;
+}
+
+/**
+ * @brief Edge capture state for one GPIO.
+ *
+ * @details
+ * The ring is single-producer/single-consumer: only the ISR advances head
+ * and only hal_gpio_edge_pop() advances tail, so neither side takes a lock.
+ * The PWM cut fields are shared in both directions and are guarded by
+ * hal_gpio_edge_lock. wake is only read by the ISR.
+ */
+typedef struct {
+    bool used;
+    bool wake;
+    int pin;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    hal_gpio_edge_event_t ring[HAL_GPIO_EDGE_RING_LEN];
+    uint32_t cut_channels;
+    hal_gpio_level_t cut_level;
+    bool cut_fired;
+    uint32_t cut_fired_channels;
+    hal_gpio_edge_cut_t cut;
+} hal_gpio_edge_slot_t;
+
+_Static_assert((HAL_GPIO_EDGE_RING_LEN & (HAL_GPIO_EDGE_RING_LEN - 1)) == 0,
+               "HAL_GPIO_EDGE_RING_LEN must be a power of two");
+
+static hal_gpio_edge_slot_t hal_gpio_edge_slots[HAL_GPIO_EDGE_SLOTS];
+static bool hal_gpio_isr_service_installed;
+static portMUX_TYPE hal_gpio_edge_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static hal_gpio_edge_slot_t *hal_gpio_edge_find(int pin) {
+    for (size_t i = 0; i < HAL_GPIO_EDGE_SLOTS; i++) {
+        if (hal_gpio_edge_slots[i].used && hal_gpio_edge_slots[i].pin == pin) {
+            return &hal_gpio_edge_slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief GPIO edge ISR: timestamps the edge and fires an armed PWM cut.
+ *
+ * @details
+ * Timestamps with esp_timer_get_time() on entry, samples the pin level from
+ * GPIO_IN_REG, and publishes the event to the ring with a release store so
+ * the consumer never sees a half-written entry. A full ring counts a drop
+ * instead of overwriting unread events. If a PWM cut is armed for the
+ * sampled level, the armed channels are forced idle here and the cut is
+ * disarmed, so the stop does not wait for the next tick. A pin with wake
+ * set also wakes a suspended tick.
+ *
+ * @param arg Capture slot for the pin.
+ */
+static void IRAM_ATTR hal_gpio_edge_isr(void *arg) {
+    hal_gpio_edge_slot_t *slot = (hal_gpio_edge_slot_t *)arg;
+    int64_t now_us = esp_timer_get_time();
+    hal_gpio_level_t level = ((REG_READ(GPIO_IN_REG) >> slot->pin) & 1U) ? HAL_GPIO_HIGH
+                                                                          : HAL_GPIO_LOW;
+
+    uint32_t head = slot->head;
+    uint32_t tail = __atomic_load_n(&slot->tail, __ATOMIC_ACQUIRE);
+    if (head - tail < HAL_GPIO_EDGE_RING_LEN) {
+        slot->ring[head & (HAL_GPIO_EDGE_RING_LEN - 1)].time_us = now_us;
+        slot->ring[head & (HAL_GPIO_EDGE_RING_LEN - 1)].level = level;
+        __atomic_store_n(&slot->head, head + 1, __ATOMIC_RELEASE);
+    } else {
+        slot->dropped++;
+    }
+
+    portENTER_CRITICAL_ISR(&hal_gpio_edge_lock);
+    if (slot->cut_channels != 0 && level == slot->cut_level) {
+        for (int channel = 0; channel < LEDC_CHANNEL_MAX; channel++) {
+            if (slot->cut_channels & (1U << channel)) {
+                hal_pwm_cut_isr(channel);
+            }
+        }
+        slot->cut_fired_channels |= slot->cut_channels;
+        slot->cut_channels = 0;
+        slot->cut_fired = true;
+        slot->cut.edge_us = now_us;
+        slot->cut.latency_us = (uint32_t)(esp_timer_get_time() - now_us);
+    }
+    portEXIT_CRITICAL_ISR(&hal_gpio_edge_lock);
+
+    if (slot->wake) {
+        hal_tick_wake_isr();
+    }
+}
+
+/**
+ * @brief Starts timestamped edge capture on a GPIO input.
+ *
+ * @details
+ * Installs the shared GPIO ISR service on first use and attaches a capture
+ * slot to the pin. Re-enabling an already captured pin changes the edge
+ * selection and discards pending events. Timestamps use esp_timer directly
+ * because hal_time_us() sources are not ISR-safe.
+ *
+ * Preconditions:
+ * - pin has been configured with hal_gpio_config_input(); reconfiguring it
+ *   afterwards disables the interrupt again.
+ *
+ * Postconditions:
+ * - Selected transitions are queued for hal_gpio_edge_pop().
+ *
+ * Side effects:
+ * - Installs the GPIO ISR service and enables the pin interrupt.
+ *
+ * Error handling:
+ * - Returns HAL_ERR_INVALID for invalid pins or edge selections, and
+ *   HAL_ERR_UNSUPPORTED when no capture slot is free or the interrupt cannot
+ *   be attached.
+ *
+ * @param pin GPIO number to capture.
+ * @param edges Transitions to capture.
+ * @return HAL_OK on success, or an error code.
+ */
+hal_status_t hal_gpio_edge_enable(int pin, hal_gpio_edge_t edges) {
+    if (!hal_gpio_valid(pin)) {
+        return HAL_ERR_INVALID;
+    }
+
+    gpio_int_type_t type;
+    switch (edges) {
+    case HAL_GPIO_EDGE_RISING:
+        type = GPIO_INTR_POSEDGE;
+        break;
+    case HAL_GPIO_EDGE_FALLING:
+        type = GPIO_INTR_NEGEDGE;
+        break;
+    case HAL_GPIO_EDGE_BOTH:
+        type = GPIO_INTR_ANYEDGE;
+        break;
+    default:
+        return HAL_ERR_INVALID;
+    }
+
+    if (!hal_gpio_isr_service_installed) {
+        esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            return HAL_ERR_UNSUPPORTED;
+        }
+        hal_gpio_isr_service_installed = true;
+    }
+
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot != NULL) {
+        gpio_intr_disable((gpio_num_t)pin);
+        gpio_isr_handler_remove((gpio_num_t)pin);
+    } else {
+        for (size_t i = 0; i < HAL_GPIO_EDGE_SLOTS; i++) {
+            if (!hal_gpio_edge_slots[i].used) {
+                slot = &hal_gpio_edge_slots[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            return HAL_ERR_UNSUPPORTED;
+        }
+    }
+
+    slot->used = true;
+    slot->wake = false;
+    slot->pin = pin;
+    slot->head = 0;
+    slot->tail = 0;
+    slot->dropped = 0;
+    slot->cut_channels = 0;
+    slot->cut_fired = false;
+    slot->cut_fired_channels = 0;
+
+    if (gpio_set_intr_type((gpio_num_t)pin, type) != ESP_OK ||
+        gpio_isr_handler_add((gpio_num_t)pin, hal_gpio_edge_isr, slot) != ESP_OK ||
+        gpio_intr_enable((gpio_num_t)pin) != ESP_OK) {
+        gpio_isr_handler_remove((gpio_num_t)pin);
+        slot->used = false;
+        return HAL_ERR_UNSUPPORTED;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Stops edge capture on a GPIO and releases its slot.
+ *
+ * @param pin GPIO number previously passed to hal_gpio_edge_enable().
+ * @return HAL_OK on success, HAL_ERR_INVALID if the pin is not captured.
+ */
+hal_status_t hal_gpio_edge_disable(int pin) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    gpio_intr_disable((gpio_num_t)pin);
+    gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove((gpio_num_t)pin);
+    slot->used = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief Selects whether edges on a captured GPIO wake a suspended tick.
+ *
+ * @details
+ * With wake set, the edge ISR notifies the tick task after queuing the
+ * event, so a tick suspended by hal_tick_suspend() resumes and runs its
+ * callback straight away. Re-enabling capture clears the flag.
+ *
+ * @param pin Captured GPIO number.
+ * @param wake True to wake the tick on every captured edge.
+ * @return HAL_OK on success, HAL_ERR_INVALID if the pin is not captured.
+ */
+hal_status_t hal_gpio_edge_set_wake(int pin, bool wake) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    slot->wake = wake;
+    return HAL_OK;
+}
+
+/**
+ * @brief Removes the oldest captured edge for a GPIO.
+ *
+ * @details
+ * Lock-free consumer side of the edge ring. Must be called from a single
+ * task per pin.
+ *
+ * @param pin Captured GPIO number.
+ * @param event Output event. Must not be NULL.
+ * @return True if an event was returned, false if none is pending.
+ */
+bool hal_gpio_edge_pop(int pin, hal_gpio_edge_event_t *event) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot == NULL || event == NULL) {
+        return false;
+    }
+    uint32_t tail = slot->tail;
+    if (__atomic_load_n(&slot->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    *event = slot->ring[tail & (HAL_GPIO_EDGE_RING_LEN - 1)];
+    __atomic_store_n(&slot->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Returns the number of edges lost because the ring was full.
+ *
+ * @param pin Captured GPIO number.
+ * @return Dropped edge count since capture was enabled, or 0.
+ */
+uint32_t hal_gpio_edge_dropped(int pin) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    return slot != NULL ? slot->dropped : 0;
+}
+
+/**
+ * @brief Arms a one-shot PWM cut on the next edge to a given level.
+ *
+ * @details
+ * When the edge ISR samples level on pin, every PWM channel in channel_mask
+ * is forced to its idle (low) output immediately, without waiting for the
+ * current PWM period or the next tick. The cut disarms itself after firing.
+ * The cut channels stay idle, whatever duty is written, until the cut is
+ * collected with hal_gpio_edge_take_cut() or a duty of 0 is written to
+ * them. Passing channel_mask 0 disarms. Re-arming discards an untaken cut
+ * report and acknowledges it like hal_gpio_edge_take_cut().
+ *
+ * Preconditions:
+ * - pin has edge capture enabled for the transition to level.
+ *
+ * @param pin Captured GPIO number.
+ * @param level Sampled level that fires the cut.
+ * @param channel_mask Bit n set to cut LEDC channel n.
+ * @return HAL_OK on success, HAL_ERR_INVALID if the pin is not captured or
+ *         the mask names channels that do not exist.
+ */
+hal_status_t hal_gpio_edge_arm_pwm_cut(int pin, hal_gpio_level_t level, uint32_t channel_mask) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot == NULL || (channel_mask >> LEDC_CHANNEL_MAX) != 0) {
+        return HAL_ERR_INVALID;
+    }
+    portENTER_CRITICAL(&hal_gpio_edge_lock);
+    uint32_t fired_channels = slot->cut_fired_channels;
+    slot->cut_level = level;
+    slot->cut_channels = channel_mask;
+    slot->cut_fired = false;
+    slot->cut_fired_channels = 0;
+    portEXIT_CRITICAL(&hal_gpio_edge_lock);
+    hal_pwm_cut_release(fired_channels);
+    return HAL_OK;
+}
+
+/**
+ * @brief Collects the report of a PWM cut fired since the last call.
+ *
+ * @details
+ * Collecting a cut acknowledges it: the channels it forced idle accept
+ * duties again, so the caller must have stopped or braked the motor it
+ * drives before the next write.
+ *
+ * @param pin Captured GPIO number.
+ * @param cut Output report. May be NULL to only clear the flag.
+ * @return True if a cut fired since the previous call.
+ */
+bool hal_gpio_edge_take_cut(int pin, hal_gpio_edge_cut_t *cut) {
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    if (slot == NULL) {
+        return false;
+    }
+    portENTER_CRITICAL(&hal_gpio_edge_lock);
+    bool fired = slot->cut_fired;
+    if (fired && cut != NULL) {
+        *cut = slot->cut;
+    }
+    uint32_t channels = fired ? slot->cut_fired_channels : 0U;
+    slot->cut_fired = false;
+    slot->cut_fired_channels = 0;
+    portEXIT_CRITICAL(&hal_gpio_edge_lock);
+    hal_pwm_cut_release(channels);
+    return fired;
+}
+
+/**
+ * @brief Software timer wheel state.
  *
  * @details
- * Limits the number of concurrent periodic timers that can be registered via
- * hal_timer_start().
+ * All HAL timers are multiplexed onto one one-shot esp_timer. Timers live in a
+ * static pool and are hashed by absolute expiry tick into
+ * HAL_TIMER_WHEEL_SLOTS doubly-linked slot lists, so start, stop and expiry
+ * are O(1) and nothing is allocated after hal_init(). A slot-occupancy bitmap
+ * lets the dispatcher skip empty slots and arm the esp_timer only for the next
+ * occupied slot; with no active timers the wheel does not wake at all.
  */
-#define HAL_TIMER_MAX 4
+#define HAL_TIMER_NONE 0xFFFFU
+#define HAL_TIMER_WHEEL_MASK (HAL_TIMER_WHEEL_SLOTS - 1U)
+#define HAL_TIMER_WHEEL_WORDS (HAL_TIMER_WHEEL_SLOTS / 32U)
+
+_Static_assert((HAL_TIMER_WHEEL_SLOTS & HAL_TIMER_WHEEL_MASK) == 0 && HAL_TIMER_WHEEL_SLOTS >= 32,
+               "HAL_TIMER_WHEEL_SLOTS must be a power of two >= 32");
+_Static_assert(HAL_TIMER_MAX > 0 && HAL_TIMER_MAX < HAL_TIMER_NONE,
+               "HAL_TIMER_MAX must fit the 16-bit slot links");
 
 typedef struct {
-    esp_timer_handle_t handle;
     hal_timer_callback_t callback;
     void *user_data;
+    uint64_t expiry_tick;
+    uint32_t period_ticks;
+    uint32_t generation;
+    uint16_t prev;
+    uint16_t next;
+    bool active;
 } hal_timer_entry_t;
 
+typedef struct {
+    uint16_t index;
+    uint32_t generation;
+} hal_timer_due_t;
+
 static hal_timer_entry_t hal_timers[HAL_TIMER_MAX];
+static hal_timer_due_t hal_timer_due[HAL_TIMER_MAX];
+static uint16_t hal_timer_slot_head[HAL_TIMER_WHEEL_SLOTS];
+static uint32_t hal_timer_slot_bitmap[HAL_TIMER_WHEEL_WORDS];
+static uint64_t hal_timer_wheel_done_tick;
+static uint64_t hal_timer_wheel_armed_tick;
+static int64_t hal_timer_wheel_epoch_us;
+static esp_timer_handle_t hal_timer_wheel_timer;
+static portMUX_TYPE hal_timer_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint64_t hal_timer_wheel_now_tick(int64_t now_us) {
+    return (uint64_t)(now_us - hal_timer_wheel_epoch_us) / HAL_TIMER_WHEEL_RES_US;
+}
+
+static void hal_timer_link(uint16_t index) {
+    hal_timer_entry_t *entry = &hal_timers[index];
+    uint32_t slot = (uint32_t)(entry->expiry_tick & HAL_TIMER_WHEEL_MASK);
+    entry->prev = HAL_TIMER_NONE;
+    entry->next = hal_timer_slot_head[slot];
+    if (entry->next != HAL_TIMER_NONE) {
+        hal_timers[entry->next].prev = index;
+    }
+    hal_timer_slot_head[slot] = index;
+    hal_timer_slot_bitmap[slot / 32U] |= 1U << (slot % 32U);
+}
+
+static void hal_timer_unlink(uint16_t index) {
+    hal_timer_entry_t *entry = &hal_timers[index];
+    uint32_t slot = (uint32_t)(entry->expiry_tick & HAL_TIMER_WHEEL_MASK);
+    if (entry->prev != HAL_TIMER_NONE) {
+        hal_timers[entry->prev].next = entry->next;
+    } else {
+        hal_timer_slot_head[slot] = entry->next;
+    }
+    if (entry->next != HAL_TIMER_NONE) {
+        hal_timers[entry->next].prev = entry->prev;
+    }
+    if (hal_timer_slot_head[slot] == HAL_TIMER_NONE) {
+        hal_timer_slot_bitmap[slot / 32U] &= ~(1U << (slot % 32U));
+    }
+    entry->prev = HAL_TIMER_NONE;
+    entry->next = HAL_TIMER_NONE;
+}
+
+/**
+ * @brief Finds the first occupied slot strictly after a tick.
+ *
+ * @details
+ * Scans the occupancy bitmap one word at a time, so the cost is bounded by
+ * HAL_TIMER_WHEEL_WORDS regardless of how many timers are active.
+ *
+ * @param after_tick Tick to search from (exclusive).
+ * @return Absolute tick of the next occupied slot, or UINT64_MAX if empty.
+ */
+static uint64_t hal_timer_wheel_next_tick(uint64_t after_tick) {
+    uint32_t start = (uint32_t)((after_tick + 1U) & HAL_TIMER_WHEEL_MASK);
+    for (uint32_t scanned = 0; scanned < HAL_TIMER_WHEEL_SLOTS;) {
+        uint32_t slot = (start + scanned) & HAL_TIMER_WHEEL_MASK;
+        uint32_t bit = slot % 32U;
+        uint32_t word = hal_timer_slot_bitmap[slot / 32U] >> bit;
+        if (word) {
+            uint32_t offset = (uint32_t)__builtin_ctz(word);
+            if (scanned + offset < HAL_TIMER_WHEEL_SLOTS) {
+                return after_tick + 1U + scanned + offset;
+            }
+            break;
+        }
+        scanned += 32U - bit;
+    }
+    return UINT64_MAX;
+}
+
+/**
+ * @brief Arms the wheel esp_timer for a tick if it is earlier than the
+ *        currently armed one. Caller holds hal_timer_lock.
+ */
+static void hal_timer_wheel_arm(uint64_t tick, int64_t now_us) {
+    if (tick == UINT64_MAX || tick >= hal_timer_wheel_armed_tick) {
+        return;
+    }
+    int64_t due_us = hal_timer_wheel_epoch_us + (int64_t)(tick * HAL_TIMER_WHEEL_RES_US);
+    int64_t delay_us = due_us - now_us;
+    if (delay_us < 1) {
+        delay_us = 1;
+    }
+    esp_timer_stop(hal_timer_wheel_timer);
+    if (esp_timer_start_once(hal_timer_wheel_timer, (uint64_t)delay_us) == ESP_OK) {
+        hal_timer_wheel_armed_tick = tick;
+    }
+}
+
+/**
+ * @brief Expires every due timer and re-arms the wheel.
+ *
+ * @details
+ * Visits only occupied slots between the last processed tick and now (every
+ * slot at most once). Periodic timers are re-hashed at their next expiry,
+ * skipping whole missed periods to stay phase-locked. Callbacks run after the
+ * lock is dropped; a timer stopped or restarted by an earlier callback in the
+ * same pass is skipped via its generation counter.
+ */
+static void hal_timer_wheel_dispatch(void *arg) {
+    (void)arg;
+    int64_t now_us = esp_timer_get_time();
+    uint64_t now_tick = hal_timer_wheel_now_tick(now_us);
+    size_t due_count = 0;
+
+    portENTER_CRITICAL(&hal_timer_lock);
+    hal_timer_wheel_armed_tick = UINT64_MAX;
+    uint64_t tick = hal_timer_wheel_done_tick;
+    uint64_t last = now_tick;
+    if (last - tick > HAL_TIMER_WHEEL_SLOTS) {
+        tick = last - HAL_TIMER_WHEEL_SLOTS;
+    }
+    while ((tick = hal_timer_wheel_next_tick(tick)) <= last) {
+        uint16_t index = hal_timer_slot_head[tick & HAL_TIMER_WHEEL_MASK];
+        while (index != HAL_TIMER_NONE) {
+            hal_timer_entry_t *entry = &hal_timers[index];
+            uint16_t next = entry->next;
+            if (entry->expiry_tick <= now_tick) {
+                hal_timer_unlink(index);
+                hal_timer_due[due_count++] = (hal_timer_due_t){ index, entry->generation };
+                if (entry->period_ticks) {
+                    uint64_t missed = (now_tick - entry->expiry_tick) / entry->period_ticks;
+                    entry->expiry_tick += (missed + 1U) * entry->period_ticks;
+                    hal_timer_link(index);
+                } else {
+                    entry->active = false;
+                }
+            }
+            index = next;
+        }
+    }
+    hal_timer_wheel_done_tick = now_tick;
+    hal_timer_wheel_arm(hal_timer_wheel_next_tick(now_tick), now_us);
+    portEXIT_CRITICAL(&hal_timer_lock);
+
+    for (size_t i = 0; i < due_count; i++) {
+        hal_timer_entry_t *entry = &hal_timers[hal_timer_due[i].index];
+        hal_timer_callback_t callback = entry->callback;
+        void *user_data = entry->user_data;
+        if (entry->generation == hal_timer_due[i].generation && callback) {
+            callback(user_data);
+        }
+    }
+}
+
+/**
+ * @brief Initializes the timer wheel and its backing esp_timer.
+ *
+ * @details
+ * Called from hal_init(). This is the only allocation made by the timer
+ * service; subsequent starts and stops only touch the static pool.
+ *
+ * @return HAL_OK on success, HAL_ERR_INVALID if the esp_timer cannot be created.
+ */
+static hal_status_t hal_timer_wheel_init(void) {
+    if (hal_timer_wheel_timer) {
+        return HAL_OK;
+    }
+    for (size_t i = 0; i < HAL_TIMER_WHEEL_SLOTS; i++) {
+        hal_timer_slot_head[i] = HAL_TIMER_NONE;
+    }
+    for (size_t i = 0; i < HAL_TIMER_MAX; i++) {
+        hal_timers[i].prev = HAL_TIMER_NONE;
+        hal_timers[i].next = HAL_TIMER_NONE;
+    }
+
+    esp_timer_create_args_t args = {
+        .callback = &hal_timer_wheel_dispatch,
+        .arg = NULL,
+        .name = "hal_timer"
+    };
+    if (esp_timer_create(&args, &hal_timer_wheel_timer) != ESP_OK) {
+        hal_timer_wheel_timer = NULL;
+        return HAL_ERR_INVALID;
+    }
+    hal_timer_wheel_epoch_us = esp_timer_get_time();
+    hal_timer_wheel_done_tick = 0;
+    hal_timer_wheel_armed_tick = UINT64_MAX;
+    return HAL_OK;
+}
 
-static void hal_timer_dispatch(void *arg) {
-    hal_timer_entry_t *entry = (hal_timer_entry_t *)arg;
-    if (entry->callback) {
-        entry->callback(entry->user_data);
+/**
+ * @brief Starts a periodic HAL timer with a millisecond period.
+ *
+ * @details
+ * Convenience wrapper around hal_timer_start_us() for periodic timers.
+ *
+ * @param timer_id Timer slot identifier in [0, HAL_TIMER_MAX).
+ * @param period_ms Period in milliseconds. Must be > 0.
+ * @param callback Function to invoke each period. Must not be NULL.
+ * @param user_data Opaque pointer passed to callback.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid parameters,
+ *         HAL_ERR_UNSUPPORTED if the timer wheel is not initialized.
+ */
+hal_status_t hal_timer_start(int timer_id, uint32_t period_ms,
+                             hal_timer_callback_t callback, void *user_data) {
+    if (period_ms == 0 || period_ms > UINT32_MAX / 1000U) {
+        return HAL_ERR_INVALID;
     }
+    return hal_timer_start_us(timer_id, period_ms * 1000U, HAL_TIMER_PERIODIC,
+                              callback, user_data);
 }
 
 /**
- * @brief Starts a periodic HAL timer.
+ * @brief Starts or restarts a periodic or one-shot HAL timer.
  *
  * @details
- * Allocates or reuses a timer slot and calls the provided callback at the
- * specified period.
+ * Hashes the timer into the wheel at its absolute expiry tick. Periods are
+ * rounded up to HAL_TIMER_WHEEL_RES_US, so a timer never fires early, and
+ * periodic timers keep a drift-free phase relative to their first expiry.
+ * Restarting an active timer reschedules it from now. Callbacks run in the
+ * esp_timer task context.
  *
  * Preconditions:
+ * - hal_init() has been called.
  * - timer_id must be in range [0, HAL_TIMER_MAX).
  * - callback must be non-null.
- * - period_ms must be > 0.
+ * - period_us must be > 0.
  *
  * Postconditions:
- * - The timer slot is active and invokes callback periodically.
+ * - The timer is active and invokes callback after period_us (and every
+ *   period_us thereafter for HAL_TIMER_PERIODIC).
  *
  * Side effects:
- * - Allocates an ESP timer and schedules periodic callbacks.
+ * - May re-arm the wheel's esp_timer. No heap allocation.
  *
  * @param timer_id Timer slot identifier.
- * @param period_ms Period in milliseconds.
- * @param callback Function to invoke each period. Must not be NULL.
+ * @param period_us Period in microseconds.
+ * @param mode HAL_TIMER_PERIODIC or HAL_TIMER_ONESHOT.
+ * @param callback Function to invoke on expiry. Must not be NULL.
  * @param user_data Opaque pointer passed to callback.
- * @return HAL_OK on success, HAL_ERR_INVALID on invalid parameters or failure.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid parameters,
+ *         HAL_ERR_UNSUPPORTED if the timer wheel is not initialized.
  */
-hal_status_t hal_timer_start(int timer_id, uint32_t period_ms,
-                             hal_timer_callback_t callback, void *user_data) {
-    if (timer_id < 0 || timer_id >= HAL_TIMER_MAX || callback == NULL || period_ms == 0) {
+hal_status_t hal_timer_start_us(int timer_id, uint32_t period_us, hal_timer_mode_t mode,
+                                hal_timer_callback_t callback, void *user_data) {
+    if (timer_id < 0 || timer_id >= HAL_TIMER_MAX || callback == NULL || period_us == 0) {
         return HAL_ERR_INVALID;
     }
-
-    hal_timer_entry_t *entry = &hal_timers[timer_id];
-    if (entry->handle) {
-        esp_timer_stop(entry->handle);
-        esp_timer_delete(entry->handle);
-        entry->handle = NULL;
-    }
-
-    esp_timer_create_args_t args = {
-        .callback = &hal_timer_dispatch,
-        .arg = entry,
-        .name = "hal_timer"
-    };
-    if (esp_timer_create(&args, &entry->handle) != ESP_OK) {
-        entry->handle = NULL;
+    if (mode != HAL_TIMER_PERIODIC && mode != HAL_TIMER_ONESHOT) {
         return HAL_ERR_INVALID;
     }
+    if (!hal_timer_wheel_timer) {
+        return HAL_ERR_UNSUPPORTED;
+    }
 
-    entry->callback = callback;
-    entry->user_data = user_data;
+    uint16_t index = (uint16_t)timer_id;
+    hal_timer_entry_t *entry = &hal_timers[index];
+    uint32_t period_ticks = (period_us + HAL_TIMER_WHEEL_RES_US - 1U) / HAL_TIMER_WHEEL_RES_US;
 
-    uint64_t period_us = (uint64_t)period_ms * 1000ULL;
-    if (esp_timer_start_periodic(entry->handle, period_us) != ESP_OK) {
-        esp_timer_delete(entry->handle);
-        entry->handle = NULL;
-        return HAL_ERR_INVALID;
+    portENTER_CRITICAL(&hal_timer_lock);
+    if (entry->active) {
+        hal_timer_unlink(index);
     }
+    int64_t now_us = esp_timer_get_time();
+    uint64_t now_rel_us = (uint64_t)(now_us - hal_timer_wheel_epoch_us);
+    entry->callback = callback;
+    entry->user_data = user_data;
+    entry->period_ticks = (mode == HAL_TIMER_PERIODIC) ? period_ticks : 0U;
+    entry->expiry_tick = (now_rel_us + period_us + HAL_TIMER_WHEEL_RES_US - 1U) /
+                         HAL_TIMER_WHEEL_RES_US;
+    if (entry->expiry_tick <= hal_timer_wheel_done_tick) {
+        entry->expiry_tick = hal_timer_wheel_done_tick + 1U;
+    }
+    entry->generation++;
+    entry->active = true;
+    hal_timer_link(index);
+    hal_timer_wheel_arm(entry->expiry_tick, now_us);
+    portEXIT_CRITICAL(&hal_timer_lock);
 
     return HAL_OK;
 }
 
 /**
- * @brief Stops a periodic HAL timer.
+ * @brief Stops a HAL timer.
  *
  * @details
- * Cancels and deletes the timer slot if it is active.
+ * Removes the timer from the wheel if it is active. A callback already
+ * collected by a concurrent dispatch pass is suppressed.
  *
  * Preconditions:
  * - timer_id must be in range [0, HAL_TIMER_MAX).
@@ -298,7 +961,8 @@ hal_status_t hal_timer_start(int timer_id, uint32_t period_ms,
  * - The timer slot is inactive.
  *
  * Side effects:
- * - Deletes the underlying ESP timer if present.
+ * - None beyond the wheel bookkeeping; the backing esp_timer is left armed
+ *   and simply finds nothing due.
  *
  * @param timer_id Timer slot identifier.
  * @return HAL_OK on success, HAL_ERR_INVALID on invalid timer_id.
@@ -308,16 +972,18 @@ hal_status_t hal_timer_stop(int timer_id) {
         return HAL_ERR_INVALID;
     }
 
-    hal_timer_entry_t *entry = &hal_timers[timer_id];
-    if (!entry->handle) {
-        return HAL_OK;
-    }
+    uint16_t index = (uint16_t)timer_id;
+    hal_timer_entry_t *entry = &hal_timers[index];
 
-    esp_timer_stop(entry->handle);
-    esp_timer_delete(entry->handle);
-    entry->handle = NULL;
+    portENTER_CRITICAL(&hal_timer_lock);
+    if (entry->active) {
+        hal_timer_unlink(index);
+        entry->active = false;
+    }
+    entry->generation++;
     entry->callback = NULL;
     entry->user_data = NULL;
+    portEXIT_CRITICAL(&hal_timer_lock);
     return HAL_OK;
 }
 
@@ -325,245 +991,1259 @@ static esp_timer_handle_t hal_tick_timer;
 static hal_timer_callback_t hal_tick_callback;
 static void *hal_tick_user_data;
 
-static void hal_tick_dispatch(void *arg) {
-    (void)arg;
-    if (hal_tick_callback) {
-        hal_tick_callback(hal_tick_user_data);
+const uint32_t hal_tick_hist_limits_us[HAL_TICK_HIST_BUCKETS] = {
+    5, 10, 25, 50, 100, 250, 1000, UINT32_MAX
+};
+
+static hal_tick_stats_t hal_tick_stats;
+static portMUX_TYPE hal_tick_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Resets a tick statistics record.
+ *
+ * @details
+ * Clears all counters and extremes and stores the nominal period used to
+ * compute period error. The first recorded tick after a reset only seeds the
+ * interval measurement.
+ *
+ * @param stats Statistics record to reset. Ignored when NULL.
+ * @param period_us Nominal tick period in microseconds.
+ */
+void hal_tick_stats_init(hal_tick_stats_t *stats, uint32_t period_us) {
+    if (stats == NULL) {
+        return;
     }
+    *stats = (hal_tick_stats_t){
+        .period_us = period_us,
+    };
 }
 
 /**
- * @brief Starts the global HAL tick timer.
+ * @brief Records one tick dispatch into a statistics record.
  *
  * @details
- * Configures a periodic ESP timer that calls the provided callback at the
- * requested frequency.
+ * Pure bookkeeping with no hardware access, so it can be driven with
+ * synthetic timestamps from a host or self-test harness. Computes the period
+ * error against the previous start timestamp, the callback duration, overrun
+ * and late-tick counts, and the absolute period-error histogram.
  *
  * Preconditions:
- * - hz must be > 0.
- * - callback must be non-null.
+ * - stats was prepared with hal_tick_stats_init().
+ * - Timestamps are monotonic microseconds.
  *
- * Postconditions:
- * - The tick callback is invoked at approximately hz.
+ * @param stats Statistics record to update. Ignored when NULL.
+ * @param start_us Timestamp taken just before the tick callback ran.
+ * @param end_us Timestamp taken just after the tick callback returned.
+ */
+void hal_tick_stats_record(hal_tick_stats_t *stats, int64_t start_us, int64_t end_us) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t duration_us = (end_us > start_us) ? (uint32_t)(end_us - start_us) : 0U;
+    stats->callback_last_us = duration_us;
+    stats->callback_total_us += duration_us;
+    if (duration_us > stats->callback_max_us) {
+        stats->callback_max_us = duration_us;
+    }
+    if (stats->period_us != 0 && duration_us >= stats->period_us) {
+        stats->overruns++;
+    }
+
+    if (stats->has_last_start) {
+        int64_t err = (start_us - stats->last_start_us) - (int64_t)stats->period_us;
+        if (err > INT32_MAX) {
+            err = INT32_MAX;
+        } else if (err < INT32_MIN) {
+            err = INT32_MIN;
+        }
+        int32_t err32 = (int32_t)err;
+        uint32_t abs_err = (err32 < 0) ? (uint32_t)(-(int64_t)err32) : (uint32_t)err32;
+
+        stats->period_err_last_us = err32;
+        if (stats->periods == 0 || err32 < stats->period_err_min_us) {
+            stats->period_err_min_us = err32;
+        }
+        if (stats->periods == 0 || err32 > stats->period_err_max_us) {
+            stats->period_err_max_us = err32;
+        }
+        if (abs_err > stats->period_err_worst_us) {
+            stats->period_err_worst_us = abs_err;
+        }
+        if (stats->period_us != 0 && err32 >= (int32_t)stats->period_us) {
+            stats->late_ticks++;
+        }
+
+        size_t bucket = 0;
+        while (bucket < HAL_TICK_HIST_BUCKETS - 1 && abs_err > hal_tick_hist_limits_us[bucket]) {
+            bucket++;
+        }
+        stats->hist[bucket]++;
+        stats->periods++;
+    }
+
+    stats->ticks++;
+    stats->last_start_us = start_us;
+    stats->has_last_start = true;
+}
+
+/**
+ * @brief Records the delay between the timer ISR and the tick callback.
+ *
+ * @details
+ * Pure bookkeeping companion to hal_tick_stats_record(). Only dispatch modes
+ * with a HAL-owned timer ISR (HAL_TICK_MODE_TASK and HAL_TICK_MODE_ISR) have a
+ * raise timestamp to measure from.
+ *
+ * @param stats Statistics record to update. Ignored when NULL.
+ * @param raised_us Timestamp taken in the timer ISR.
+ * @param start_us Timestamp taken just before the tick callback ran.
+ */
+void hal_tick_stats_record_latency(hal_tick_stats_t *stats, int64_t raised_us, int64_t start_us) {
+    if (stats == NULL) {
+        return;
+    }
+    uint32_t latency_us = (start_us > raised_us) ? (uint32_t)(start_us - raised_us) : 0U;
+    stats->latency_last_us = latency_us;
+    stats->latency_total_us += latency_us;
+    if (latency_us > stats->latency_max_us) {
+        stats->latency_max_us = latency_us;
+    }
+    stats->dispatches++;
+}
+
+static hal_tick_mode_t hal_tick_mode;
+static gptimer_handle_t hal_tick_gptimer;
+static TaskHandle_t hal_tick_task_handle;
+static uint32_t hal_tick_task_stack_bytes;
+/** Oldest alarm not yet dispatched; only stored while no alarm is pending. */
+static int64_t hal_tick_raised_us;
+static bool hal_tick_raised_pending;
+/** The GPTimer is stopped until the next wake; cleared by the tick task only. */
+static volatile bool hal_tick_suspended;
+
+/**
+ * @brief Notification bits delivered to the tick task.
+ */
+enum hal_tick_notify_bits {
+    HAL_TICK_NOTIFY_ALARM = 1U << 0,
+    HAL_TICK_NOTIFY_WAKE = 1U << 1,
+};
+
+/**
+ * @brief Runs the tick callback and records its timing.
+ *
+ * @details
+ * Shared by every dispatch mode. Uses the _SAFE critical section variants so
+ * it is valid from both task and ISR context. The pending alarm is taken
+ * before the callback runs, so an alarm raised during the callback stores
+ * a fresh timestamp for the next dispatch.
+ *
+ * @param has_raised True when a timer ISR timestamp is available.
+ */
+static void hal_tick_run(bool has_raised) {
+    if (!hal_tick_callback) {
+        return;
+    }
+
+    int64_t raised_us = 0;
+    if (has_raised) {
+        portENTER_CRITICAL_SAFE(&hal_tick_stats_lock);
+        raised_us = hal_tick_raised_us;
+        hal_tick_raised_pending = false;
+        portEXIT_CRITICAL_SAFE(&hal_tick_stats_lock);
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    hal_tick_callback(hal_tick_user_data);
+    int64_t end_us = esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&hal_tick_stats_lock);
+    if (has_raised) {
+        hal_tick_stats_record_latency(&hal_tick_stats, raised_us, start_us);
+    }
+    hal_tick_stats_record(&hal_tick_stats, start_us, end_us);
+    portEXIT_CRITICAL_SAFE(&hal_tick_stats_lock);
+}
+
+static void hal_tick_dispatch(void *arg) {
+    (void)arg;
+    hal_tick_run(false);
+}
+
+/**
+ * @brief GPTimer alarm: timestamps the alarm and dispatches or notifies.
+ *
+ * @details
+ * Task notifications merge alarms the task has not caught up with, so the
+ * timestamp is only stored when no alarm is pending and latency is measured
+ * from the oldest undispatched alarm.
+ */
+static bool IRAM_ATTR hal_tick_isr(gptimer_handle_t timer,
+                                   const gptimer_alarm_event_data_t *edata, void *ctx) {
+    (void)timer;
+    (void)edata;
+    (void)ctx;
+
+    portENTER_CRITICAL_ISR(&hal_tick_stats_lock);
+    if (!hal_tick_raised_pending) {
+        hal_tick_raised_us = esp_timer_get_time();
+        hal_tick_raised_pending = true;
+    }
+    portEXIT_CRITICAL_ISR(&hal_tick_stats_lock);
+
+    if (hal_tick_mode == HAL_TICK_MODE_ISR) {
+        hal_tick_run(true);
+        return false;
+    }
+
+    BaseType_t woken = pdFALSE;
+    if (hal_tick_task_handle) {
+        xTaskNotifyFromISR(hal_tick_task_handle, HAL_TICK_NOTIFY_ALARM, eSetBits, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Wakes a suspended tick from an ISR.
+ *
+ * @details
+ * Only sets a notification bit; a tick that is not suspended ignores it and
+ * runs on its next alarm.
+ */
+static void IRAM_ATTR hal_tick_wake_isr(void) {
+    BaseType_t woken = pdFALSE;
+    if (hal_tick_task_handle) {
+        xTaskNotifyFromISR(hal_tick_task_handle, HAL_TICK_NOTIFY_WAKE, eSetBits, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Restarts the GPTimer of a suspended tick.
+ *
+ * @details
+ * The interval spanning the suspension is not a tick period, so the next
+ * callback only reseeds the period measurement.
+ *
+ * @return HAL_OK on success, HAL_ERR_INVALID if the timer cannot start.
+ */
+static hal_status_t hal_tick_resume(void) {
+    if (!hal_tick_gptimer || gptimer_start(hal_tick_gptimer) != ESP_OK) {
+        return HAL_ERR_INVALID;
+    }
+    portENTER_CRITICAL(&hal_tick_stats_lock);
+    hal_tick_stats.has_last_start = false;
+    hal_tick_raised_pending = false;
+    portEXIT_CRITICAL(&hal_tick_stats_lock);
+    hal_tick_suspended = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief Dedicated tick task: runs the callback on each alarm or wake.
+ *
+ * @details
+ * While running, only alarms dispatch the callback; wakes are dropped since
+ * the next alarm is at most one period away. While suspended, alarms are
+ * stale and a wake restarts the timer and dispatches immediately. A wake
+ * posted while the callback was suspending the tick is still pending when
+ * the task waits again, so it cannot be lost.
+ *
+ * @param arg Unused.
+ */
+static void hal_tick_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+        if (hal_tick_suspended) {
+            if ((bits & HAL_TICK_NOTIFY_WAKE) == 0 || hal_tick_resume() != HAL_OK) {
+                continue;
+            }
+            hal_tick_run(false);
+        } else if (bits & HAL_TICK_NOTIFY_ALARM) {
+            hal_tick_run(true);
+        }
+    }
+}
+
+/**
+ * @brief Creates or retunes the dedicated tick task.
+ *
+ * @details
+ * The task is created once and reused across start/stop cycles; it only
+ * blocks on its notification while the tick is stopped. A different stack
+ * size requires recreating it, which is safe because no timer is running.
+ *
+ * @param config Dispatch configuration with task priority and stack size.
+ * @return HAL_OK on success, HAL_ERR_INVALID if the task cannot be created.
+ */
+static hal_status_t hal_tick_task_prepare(const hal_tick_config_t *config) {
+    if (hal_tick_task_handle && hal_tick_task_stack_bytes != config->task_stack_bytes) {
+        vTaskDelete(hal_tick_task_handle);
+        hal_tick_task_handle = NULL;
+    }
+    if (hal_tick_task_handle) {
+        vTaskPrioritySet(hal_tick_task_handle, config->task_priority);
+        return HAL_OK;
+    }
+    if (xTaskCreate(hal_tick_task, "hal_tick", config->task_stack_bytes, NULL,
+                    config->task_priority, &hal_tick_task_handle) != pdPASS) {
+        hal_tick_task_handle = NULL;
+        return HAL_ERR_INVALID;
+    }
+    hal_tick_task_stack_bytes = config->task_stack_bytes;
+    return HAL_OK;
+}
+
+static hal_status_t hal_tick_start_esp_timer(uint64_t period_us) {
+    esp_timer_create_args_t args = {
+        .callback = &hal_tick_dispatch,
+        .arg = NULL,
+        .name = "hal_tick"
+    };
+    if (esp_timer_create(&args, &hal_tick_timer) != ESP_OK) {
+        hal_tick_timer = NULL;
+        return HAL_ERR_INVALID;
+    }
+    if (esp_timer_start_periodic(hal_tick_timer, period_us) != ESP_OK) {
+        esp_timer_delete(hal_tick_timer);
+        hal_tick_timer = NULL;
+        return HAL_ERR_INVALID;
+    }
+    return HAL_OK;
+}
+
+static hal_status_t hal_tick_start_gptimer(uint64_t period_us) {
+    gptimer_config_t timer_cfg = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    if (gptimer_new_timer(&timer_cfg, &hal_tick_gptimer) != ESP_OK) {
+        hal_tick_gptimer = NULL;
+        return HAL_ERR_INVALID;
+    }
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = hal_tick_isr,
+    };
+    gptimer_alarm_config_t alarm_cfg = {
+        .alarm_count = period_us,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    if (gptimer_register_event_callbacks(hal_tick_gptimer, &cbs, NULL) != ESP_OK ||
+        gptimer_set_alarm_action(hal_tick_gptimer, &alarm_cfg) != ESP_OK ||
+        gptimer_enable(hal_tick_gptimer) != ESP_OK) {
+        gptimer_del_timer(hal_tick_gptimer);
+        hal_tick_gptimer = NULL;
+        return HAL_ERR_INVALID;
+    }
+    if (gptimer_start(hal_tick_gptimer) != ESP_OK) {
+        gptimer_disable(hal_tick_gptimer);
+        gptimer_del_timer(hal_tick_gptimer);
+        hal_tick_gptimer = NULL;
+        return HAL_ERR_INVALID;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Starts the global HAL tick with the default dispatch configuration.
+ *
+ * @details
+ * Equivalent to hal_tick_start_ex() with HAL_TICK_MODE_DEFAULT and the tick
+ * task priority/stack defaults from hal_config.h.
+ *
+ * @param hz Tick frequency in Hertz.
+ * @param callback Function to invoke on each tick. Must not be NULL.
+ * @param user_data Opaque pointer passed to callback.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure.
+ */
+hal_status_t hal_tick_start(uint32_t hz, hal_timer_callback_t callback, void *user_data) {
+    hal_tick_config_t config = {
+        .mode = HAL_TICK_MODE_DEFAULT,
+        .task_priority = HAL_TICK_TASK_PRIORITY,
+        .task_stack_bytes = HAL_TICK_TASK_STACK_BYTES,
+    };
+    return hal_tick_start_ex(hz, &config, callback, user_data);
+}
+
+/**
+ * @brief Starts the global HAL tick in the requested dispatch mode.
+ *
+ * @details
+ * HAL_TICK_MODE_TIMER_TASK runs the callback from the shared esp_timer task,
+ * where any other esp_timer user can delay it. HAL_TICK_MODE_TASK arms a
+ * dedicated GPTimer whose ISR only timestamps the alarm and notifies a
+ * private tick task; the task runs the callback at its own priority, so
+ * latency is bounded by higher-priority tasks only. HAL_TICK_MODE_ISR runs the
+ * callback inside the GPTimer ISR and is only suitable for short, ISR-safe
+ * callbacks. Restarting stops any tick that is already running.
+ *
+ * Preconditions:
+ * - hz must be > 0 and at most 1 MHz.
+ * - callback and config must be non-null.
+ *
+ * Postconditions:
+ * - The tick callback is invoked at approximately hz.
+ * - Tick statistics are reset for the new period.
+ *
+ * Side effects:
+ * - Allocates and starts an ESP timer or GPTimer.
+ * - Creates the tick task on first use of HAL_TICK_MODE_TASK.
+ *
+ * @param hz Tick frequency in Hertz.
+ * @param config Dispatch mode, task priority and task stack size.
+ * @param callback Function to invoke on each tick. Must not be NULL.
+ * @param user_data Opaque pointer passed to callback.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure.
+ */
+hal_status_t hal_tick_start_ex(uint32_t hz, const hal_tick_config_t *config,
+                               hal_timer_callback_t callback, void *user_data) {
+    if (hz == 0 || config == NULL || callback == NULL) {
+        return HAL_ERR_INVALID;
+    }
+
+    hal_tick_stop();
+
+    uint64_t period_us = 1000000ULL / hz;
+    if (period_us == 0) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (config->mode == HAL_TICK_MODE_TASK && hal_tick_task_prepare(config) != HAL_OK) {
+        return HAL_ERR_INVALID;
+    }
+
+    hal_tick_mode = config->mode;
+    hal_tick_callback = callback;
+    hal_tick_user_data = user_data;
+
+    portENTER_CRITICAL(&hal_tick_stats_lock);
+    hal_tick_stats_init(&hal_tick_stats, (uint32_t)period_us);
+    portEXIT_CRITICAL(&hal_tick_stats_lock);
+
+    hal_status_t status = HAL_ERR_INVALID;
+    switch (config->mode) {
+    case HAL_TICK_MODE_TIMER_TASK:
+        status = hal_tick_start_esp_timer(period_us);
+        break;
+    case HAL_TICK_MODE_TASK:
+    case HAL_TICK_MODE_ISR:
+        status = hal_tick_start_gptimer(period_us);
+        break;
+    default:
+        break;
+    }
+
+    if (status != HAL_OK) {
+        hal_tick_callback = NULL;
+        hal_tick_user_data = NULL;
+    }
+    return status;
+}
+
+/**
+ * @brief Stops the global HAL tick timer.
+ *
+ * @details
+ * Cancels and deletes whichever tick timer is active. The dedicated tick
+ * task, if any, stays blocked for reuse by the next start.
+ *
+ * Preconditions:
+ * - Must not be called from the tick callback itself.
+ *
+ * Postconditions:
+ * - The global tick timer is inactive.
+ *
+ * Side effects:
+ * - Deletes the underlying ESP timer or GPTimer.
+ *
+ * @return HAL_OK on success.
+ */
+hal_status_t hal_tick_stop(void) {
+    if (hal_tick_timer) {
+        esp_timer_stop(hal_tick_timer);
+        esp_timer_delete(hal_tick_timer);
+        hal_tick_timer = NULL;
+    }
+    if (hal_tick_gptimer) {
+        gptimer_stop(hal_tick_gptimer);
+        gptimer_disable(hal_tick_gptimer);
+        gptimer_del_timer(hal_tick_gptimer);
+        hal_tick_gptimer = NULL;
+    }
+    hal_tick_callback = NULL;
+    hal_tick_user_data = NULL;
+    hal_tick_suspended = false;
+    hal_tick_raised_pending = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief Stops the tick timer until the next wake.
+ *
+ * @details
+ * For callers with nothing periodic to do. The dedicated tick task stays
+ * blocked until hal_tick_wake() or an edge on a pin with
+ * hal_gpio_edge_set_wake(), then restarts the timer and runs the callback
+ * at once. Only HAL_TICK_MODE_TASK has a task to wake.
+ *
+ * Preconditions:
+ * - Called from the tick callback, so the suspension cannot race an alarm
+ *   being dispatched.
+ *
+ * @return HAL_OK when suspended, HAL_ERR_INVALID if no tick is running,
+ *         HAL_ERR_UNSUPPORTED in the other dispatch modes.
+ */
+hal_status_t hal_tick_suspend(void) {
+    if (!hal_tick_callback) {
+        return HAL_ERR_INVALID;
+    }
+    if (hal_tick_mode != HAL_TICK_MODE_TASK || !hal_tick_gptimer) {
+        return HAL_ERR_UNSUPPORTED;
+    }
+    if (!hal_tick_suspended) {
+        if (gptimer_stop(hal_tick_gptimer) != ESP_OK) {
+            return HAL_ERR_INVALID;
+        }
+        hal_tick_suspended = true;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Wakes a tick suspended by hal_tick_suspend().
+ *
+ * @details
+ * Safe from any task, not from an ISR. Does nothing visible while the tick
+ * is running.
+ */
+void hal_tick_wake(void) {
+    if (hal_tick_task_handle) {
+        xTaskNotify(hal_tick_task_handle, HAL_TICK_NOTIFY_WAKE, eSetBits);
+    }
+}
+
+/**
+ * @brief Copies the current tick timing statistics.
+ *
+ * @details
+ * Takes a consistent snapshot of the statistics maintained by the tick
+ * dispatcher. Statistics keep accumulating until hal_tick_reset_stats() or
+ * the next hal_tick_start().
+ *
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID if stats is NULL.
+ */
+hal_status_t hal_tick_get_stats(hal_tick_stats_t *stats) {
+    if (stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    portENTER_CRITICAL(&hal_tick_stats_lock);
+    *stats = hal_tick_stats;
+    portEXIT_CRITICAL(&hal_tick_stats_lock);
+    return HAL_OK;
+}
+
+/**
+ * @brief Clears the tick timing statistics at runtime.
+ *
+ * @details
+ * Keeps the nominal period of the running tick. The next tick after the
+ * reset seeds a fresh interval measurement.
+ *
+ * Side effects:
+ * - Discards all accumulated tick statistics.
+ */
+void hal_tick_reset_stats(void) {
+    portENTER_CRITICAL(&hal_tick_stats_lock);
+    hal_tick_stats_init(&hal_tick_stats, hal_tick_stats.period_us);
+    portEXIT_CRITICAL(&hal_tick_stats_lock);
+}
+
+static ledc_timer_t hal_pwm_select_timer(int pin) {
+    if (pin == BOARD_GPIO_MOTOR_IN1 || pin == BOARD_GPIO_MOTOR_IN2) {
+        return LEDC_TIMER_1;
+    }
+    return LEDC_TIMER_0;
+}
+
+static ledc_timer_bit_t hal_pwm_bits_to_ledc(uint32_t bits) {
+    if (bits < 1) {
+        bits = 1;
+    }
+    if (bits >= LEDC_TIMER_BIT_MAX) {
+        bits = LEDC_TIMER_BIT_MAX - 1;
+    }
+    return (ledc_timer_bit_t)bits;
+}
+
+/**
+ * @brief PWM channel configuration and duty shadow.
+ *
+ * @details
+ * duty mirrors the value last written to the LEDC so unchanged requests can
+ * be dropped; shadow_valid is cleared whenever the hardware output may no
+ * longer match it. cut_gen is bumped by hal_pwm_cut_isr() so a write that
+ * raced with an ISR cut does not re-validate the shadow. cut_latched is set
+ * by the same cut and keeps the output idle until the cut is acknowledged;
+ * writes do not clear it. fading is set while a hardware fade runs and
+ * cleared by the LEDC fade-end callback.
+ */
+typedef struct {
+    bool configured;
+    int pin;
+    ledc_timer_t timer;
+    uint32_t duty_max;
+    uint32_t duty;
+    bool shadow_valid;
+    volatile uint32_t cut_gen;
+    volatile bool cut_latched;
+    volatile bool fading;
+    bool fade_cb_registered;
+    hal_pwm_channel_stats_t stats;
+} hal_pwm_channel_t;
+
+_Static_assert(HAL_PWM_FRAME_CHANNELS <= LEDC_CHANNEL_MAX,
+               "HAL_PWM_FRAME_CHANNELS exceeds the LEDC channel count");
+
+static hal_pwm_channel_t hal_pwm_channels[LEDC_CHANNEL_MAX];
+static portMUX_TYPE hal_pwm_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool hal_pwm_timer_configured[LEDC_TIMER_MAX];
+static uint32_t hal_pwm_timer_freq[LEDC_TIMER_MAX];
+static uint32_t hal_pwm_timer_bits[LEDC_TIMER_MAX];
+static bool hal_pwm_fade_installed;
+
+/**
+ * @brief Initializes a PWM channel for a GPIO pin.
+ *
+ * @details
+ * Configures the LEDC timer and channel for the requested frequency and
+ * resolution. Motor pins are placed on a separate LEDC timer to preserve
+ * frequency settings.
+ *
+ * Preconditions:
+ * - channel must be in [0, LEDC_CHANNEL_MAX).
+ * - pin must be a valid output-capable GPIO.
+ *
+ * Postconditions:
+ * - The PWM channel is configured and ready for duty updates.
+ *
+ * Side effects:
+ * - Allocates/updates LEDC timer and channel configuration.
+ *
+ * @param channel LEDC channel index.
+ * @param pin GPIO number to drive with PWM.
+ * @param freq_hz PWM frequency in Hertz.
+ * @param duty_resolution_bits Duty resolution in bits.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure.
+ */
+hal_status_t hal_pwm_init(int channel, int pin, uint32_t freq_hz,
+                          uint32_t duty_resolution_bits) {
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX) {
+        return HAL_ERR_INVALID;
+    }
+    if (!hal_gpio_output_valid(pin)) {
+        return HAL_ERR_INVALID;
+    }
+
+    ledc_timer_t timer = hal_pwm_select_timer(pin);
+    ledc_timer_bit_t res = hal_pwm_bits_to_ledc(duty_resolution_bits);
+
+    if (!hal_pwm_timer_configured[timer] ||
+        hal_pwm_timer_freq[timer] != freq_hz ||
+        hal_pwm_timer_bits[timer] != duty_resolution_bits) {
+        ledc_timer_config_t timer_cfg = {
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .timer_num = timer,
+            .duty_resolution = res,
+            .freq_hz = freq_hz,
+            .clk_cfg = LEDC_AUTO_CLK,
+        };
+        if (ledc_timer_config(&timer_cfg) != ESP_OK) {
+            return HAL_ERR_INVALID;
+        }
+        hal_pwm_timer_configured[timer] = true;
+        hal_pwm_timer_freq[timer] = freq_hz;
+        hal_pwm_timer_bits[timer] = duty_resolution_bits;
+    }
+
+    ledc_channel_config_t channel_cfg = {
+        .gpio_num = pin,
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = (ledc_channel_t)channel,
+        .timer_sel = timer,
+        .duty = 0,
+        .hpoint = 0,
+    };
+    if (ledc_channel_config(&channel_cfg) != ESP_OK) {
+        return HAL_ERR_INVALID;
+    }
+
+    hal_pwm_channels[channel].configured = true;
+    hal_pwm_channels[channel].pin = pin;
+    hal_pwm_channels[channel].timer = timer;
+    hal_pwm_channels[channel].duty = 0;
+    hal_pwm_channels[channel].shadow_valid = true;
+    hal_pwm_channels[channel].cut_latched = false;
+    hal_pwm_channels[channel].fading = false;
+    if (duty_resolution_bits >= 31) {
+        hal_pwm_channels[channel].duty_max = 0xFFFFFFFFU;
+    } else {
+        hal_pwm_channels[channel].duty_max = (1U << duty_resolution_bits) - 1U;
+    }
+
+    return HAL_OK;
+}
+
+#if !HAL_PWM_FAST_PATH || defined(HAL_SELFTEST)
+/**
+ * @brief Writes a duty through the LEDC driver.
+ *
+ * @param channel Configured LEDC channel index.
+ * @param duty Duty value, already clamped.
+ * @return True when both driver calls succeed.
+ */
+static bool hal_pwm_update_driver(int channel, uint32_t duty) {
+    return ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, duty) == ESP_OK &&
+           ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel) == ESP_OK;
+}
+#endif
+
+#if HAL_PWM_FAST_PATH || defined(HAL_SELFTEST)
+/**
+ * @brief Loads a duty into the LEDC channel registers without latching it.
+ *
+ * @details
+ * Issues the register sequence of ledc_set_duty() plus the output enable of
+ * ledc_update_duty() for a plain duty (integer part, one increment step)
+ * without the driver's argument checks and spinlock. Nothing reaches the
+ * output until hal_pwm_latch_ll(). The caller holds hal_pwm_lock, which
+ * also orders it against hal_pwm_cut_isr(); a channel latched idle by a
+ * cut keeps its output disabled.
+ *
+ * Preconditions:
+ * - The channel was configured by the LEDC driver and is not fading.
+ *
+ * @param channel Configured LEDC channel index.
+ * @param duty Duty value, already clamped.
+ */
+static void hal_pwm_stage_ll(int channel, uint32_t duty) {
+    ledc_channel_t ch = (ledc_channel_t)channel;
+    ledc_ll_set_duty_int_part(&LEDC, LEDC_LOW_SPEED_MODE, ch, duty);
+    ledc_ll_set_duty_direction(&LEDC, LEDC_LOW_SPEED_MODE, ch, LEDC_DUTY_DIR_INCREASE);
+    ledc_ll_set_duty_num(&LEDC, LEDC_LOW_SPEED_MODE, ch, 1);
+    ledc_ll_set_duty_cycle(&LEDC, LEDC_LOW_SPEED_MODE, ch, 1);
+    ledc_ll_set_duty_scale(&LEDC, LEDC_LOW_SPEED_MODE, ch, 0);
+    ledc_ll_set_sig_out_en(&LEDC, LEDC_LOW_SPEED_MODE, ch,
+                           !hal_pwm_channels[channel].cut_latched);
+    ledc_ll_set_duty_start(&LEDC, LEDC_LOW_SPEED_MODE, ch, true);
+}
+
+/**
+ * @brief Requests that a staged duty takes effect on the next PWM period.
+ *
+ * @param channel Configured LEDC channel index.
+ */
+static void hal_pwm_latch_ll(int channel) {
+    ledc_ll_ls_channel_update(&LEDC, LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel);
+}
+
+/**
+ * @brief Writes a duty straight to the LEDC channel registers.
+ *
+ * @param channel Configured LEDC channel index.
+ * @param duty Duty value, already clamped.
+ */
+static void hal_pwm_update_ll(int channel, uint32_t duty) {
+    hal_pwm_stage_ll(channel, duty);
+    hal_pwm_latch_ll(channel);
+}
+#endif
+
+/**
+ * @brief Stops a hardware fade still running on a channel.
+ *
+ * @param channel Configured LEDC channel index.
+ * @return HAL_OK when no fade is running any more, HAL_ERR_INVALID on
+ *         driver failure.
+ */
+static hal_status_t hal_pwm_fade_cancel(int channel) {
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    if (!ch->fading) {
+        return HAL_OK;
+    }
+    if (ledc_fade_stop(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel) != ESP_OK) {
+        return HAL_ERR_INVALID;
+    }
+    ch->fading = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief Forces a PWM channel output to its idle level at once.
+ *
+ * @param channel Configured LEDC channel index.
+ */
+static void IRAM_ATTR hal_pwm_idle_ll(int channel) {
+    ledc_ll_set_idle_level(&LEDC, LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, 0);
+    ledc_ll_set_sig_out_en(&LEDC, LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, false);
+    ledc_ll_ls_channel_update(&LEDC, LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel);
+}
+
+/**
+ * @brief Reports whether an ISR cut still holds a channel idle.
+ *
+ * @details
+ * A duty of 0 acknowledges the cut, since it asks for the level the cut
+ * already drives. Any other duty is held back until the cut is collected,
+ * so a frame computed before the cut cannot re-drive the output. The
+ * caller holds hal_pwm_lock.
+ *
+ * @param ch Channel state.
+ * @param duty Requested duty.
+ * @return True when the request must not reach the hardware.
+ */
+static bool hal_pwm_cut_holds(hal_pwm_channel_t *ch, uint32_t duty) {
+    if (ch->cut_latched && duty == 0) {
+        ch->cut_latched = false;
+    }
+    return ch->cut_latched;
+}
+
+/**
+ * @brief Acknowledges ISR cuts so the channels accept duties again.
+ *
+ * @details
+ * The shadows stay invalid, so the next request writes the hardware and
+ * re-enables the output.
+ *
+ * @param channel_mask Bit n set to release LEDC channel n.
+ */
+static void hal_pwm_cut_release(uint32_t channel_mask) {
+    portENTER_CRITICAL(&hal_pwm_lock);
+    for (; channel_mask != 0; channel_mask &= channel_mask - 1U) {
+        hal_pwm_channels[__builtin_ctz(channel_mask)].cut_latched = false;
+    }
+    portEXIT_CRITICAL(&hal_pwm_lock);
+}
+
+/**
+ * @brief Writes a clamped duty through the shadow.
+ *
+ * @details
+ * Requests that match the shadowed duty return without touching the LEDC
+ * driver; a failed write invalidates the shadow so the next request retries.
+ * A hardware fade still running on the channel is stopped first, so a
+ * direct write always wins over an animation. With HAL_PWM_FAST_PATH the
+ * duty goes to the channel registers inside the PWM critical section, so
+ * the write and the shadow update cannot be split by an ISR cut. A channel
+ * held by an unacknowledged cut keeps its output idle and its shadow
+ * invalid; on the driver path a cut that lands during the write is
+ * re-applied after it.
+ *
+ * @param channel Configured LEDC channel index.
+ * @param duty Duty value in channel resolution units.
+ * @return HAL_OK on success, HAL_ERR_INVALID on driver failure.
+ */
+static hal_status_t hal_pwm_write(int channel, uint32_t duty) {
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    if (duty > ch->duty_max) {
+        duty = ch->duty_max;
+    }
+    ch->stats.requests++;
+    if (ch->shadow_valid && ch->duty == duty) {
+        return HAL_OK;
+    }
+
+    portENTER_CRITICAL(&hal_pwm_lock);
+    bool held = hal_pwm_cut_holds(ch, duty);
+    portEXIT_CRITICAL(&hal_pwm_lock);
+    if (held) {
+        return HAL_OK;
+    }
+
+    if (hal_pwm_fade_cancel(channel) != HAL_OK) {
+        return HAL_ERR_INVALID;
+    }
+
+#if HAL_PWM_FAST_PATH
+    portENTER_CRITICAL(&hal_pwm_lock);
+    held = hal_pwm_cut_holds(ch, duty);
+    if (!held) {
+        hal_pwm_update_ll(channel, duty);
+        ch->duty = duty;
+        ch->shadow_valid = true;
+    }
+    portEXIT_CRITICAL(&hal_pwm_lock);
+    if (held) {
+        return HAL_OK;
+    }
+#else
+    uint32_t cut_gen = ch->cut_gen;
+    ch->shadow_valid = false;
+    if (!hal_pwm_update_driver(channel, duty)) {
+        return HAL_ERR_INVALID;
+    }
+    portENTER_CRITICAL(&hal_pwm_lock);
+    ch->duty = duty;
+    ch->shadow_valid = (ch->cut_gen == cut_gen);
+    if (ch->cut_latched) {
+        hal_pwm_idle_ll(channel);
+    }
+    portEXIT_CRITICAL(&hal_pwm_lock);
+#endif
+    ch->stats.writes++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Updates the PWM duty for a configured channel.
+ *
+ * @details
+ * Clamps duty to the configured maximum for the channel before updating.
+ * Requests for the duty already in hardware are dropped by the shadow.
+ *
+ * Preconditions:
+ * - channel must be configured via hal_pwm_init().
+ *
+ * Side effects:
+ * - Updates LEDC duty and commits it to hardware when it changed.
+ *
+ * @param channel LEDC channel index.
+ * @param duty Duty value in channel resolution units.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure,
+ *         HAL_ERR_UNSUPPORTED if the channel is not configured.
+ */
+hal_status_t hal_pwm_set_duty(int channel, uint32_t duty) {
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX) {
+        return HAL_ERR_INVALID;
+    }
+    if (!hal_pwm_channels[channel].configured) {
+        return HAL_ERR_UNSUPPORTED;
+    }
+    return hal_pwm_write(channel, duty);
+}
+
+/**
+ * @brief Updates two PWM channels so both duties latch on the same period.
+ *
+ * @details
+ * Intended for the two inputs of an H-bridge: both channels must share an
+ * LEDC timer, so their periods start together. With HAL_PWM_FAST_PATH both
+ * duties are staged first and then latched by back-to-back register writes
+ * inside one critical section, so the bridge never runs a period with one
+ * input updated and the other stale. The driver path issues both
+ * ledc_set_duty() calls before both ledc_update_duty() calls, which narrows
+ * but cannot close that window. Nothing is written when both duties match
+ * their shadows; otherwise both channels are written. While an ISR cut
+ * holds either channel idle, neither is written, so the bridge is not
+ * re-driven on one input; see hal_pwm_write().
+ *
+ * Preconditions:
+ * - Both channels are configured via hal_pwm_init() on the same timer.
  *
  * Side effects:
- * - Allocates and starts an ESP timer.
- *
- * @param hz Tick frequency in Hertz.
- * @param callback Function to invoke on each tick. Must not be NULL.
- * @param user_data Opaque pointer passed to callback.
- * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure.
+ * - Cancels hardware fades on either channel.
+ * - Updates LEDC duty for both channels when either changed.
+ *
+ * @param channel_a First LEDC channel index.
+ * @param duty_a Duty for channel_a in channel resolution units.
+ * @param channel_b Second LEDC channel index, distinct from channel_a.
+ * @param duty_b Duty for channel_b in channel resolution units.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid params, mismatched
+ *         timers or driver failure, HAL_ERR_UNSUPPORTED if a channel is not
+ *         configured.
  */
-hal_status_t hal_tick_start(uint32_t hz, hal_timer_callback_t callback, void *user_data) {
-    if (hz == 0 || callback == NULL) {
+hal_status_t hal_pwm_set_duty_pair(int channel_a, uint32_t duty_a,
+                                   int channel_b, uint32_t duty_b) {
+    if (channel_a < 0 || channel_a >= LEDC_CHANNEL_MAX ||
+        channel_b < 0 || channel_b >= LEDC_CHANNEL_MAX || channel_a == channel_b) {
         return HAL_ERR_INVALID;
     }
-
-    if (hal_tick_timer) {
-        esp_timer_stop(hal_tick_timer);
-        esp_timer_delete(hal_tick_timer);
-        hal_tick_timer = NULL;
+    hal_pwm_channel_t *a = &hal_pwm_channels[channel_a];
+    hal_pwm_channel_t *b = &hal_pwm_channels[channel_b];
+    if (!a->configured || !b->configured) {
+        return HAL_ERR_UNSUPPORTED;
     }
-
-    uint64_t period_us = 1000000ULL / hz;
-    if (period_us == 0) {
+    if (a->timer != b->timer) {
         return HAL_ERR_INVALID;
     }
-
-    esp_timer_create_args_t args = {
-        .callback = &hal_tick_dispatch,
-        .arg = NULL,
-        .name = "hal_tick"
-    };
-    if (esp_timer_create(&args, &hal_tick_timer) != ESP_OK) {
-        hal_tick_timer = NULL;
-        return HAL_ERR_INVALID;
+    if (duty_a > a->duty_max) {
+        duty_a = a->duty_max;
+    }
+    if (duty_b > b->duty_max) {
+        duty_b = b->duty_max;
+    }
+    a->stats.requests++;
+    b->stats.requests++;
+    if (a->shadow_valid && a->duty == duty_a && b->shadow_valid && b->duty == duty_b) {
+        return HAL_OK;
     }
 
-    hal_tick_callback = callback;
-    hal_tick_user_data = user_data;
+    portENTER_CRITICAL(&hal_pwm_lock);
+    bool held_a = hal_pwm_cut_holds(a, duty_a);
+    bool held_b = hal_pwm_cut_holds(b, duty_b);
+    portEXIT_CRITICAL(&hal_pwm_lock);
+    if (held_a || held_b) {
+        return HAL_OK;
+    }
 
-    if (esp_timer_start_periodic(hal_tick_timer, period_us) != ESP_OK) {
-        esp_timer_delete(hal_tick_timer);
-        hal_tick_timer = NULL;
+    if (hal_pwm_fade_cancel(channel_a) != HAL_OK || hal_pwm_fade_cancel(channel_b) != HAL_OK) {
         return HAL_ERR_INVALID;
     }
 
+#if HAL_PWM_FAST_PATH
+    portENTER_CRITICAL(&hal_pwm_lock);
+    bool held = a->cut_latched || b->cut_latched;
+    if (!held) {
+        hal_pwm_stage_ll(channel_a, duty_a);
+        hal_pwm_stage_ll(channel_b, duty_b);
+        hal_pwm_latch_ll(channel_a);
+        hal_pwm_latch_ll(channel_b);
+        a->duty = duty_a;
+        b->duty = duty_b;
+        a->shadow_valid = true;
+        b->shadow_valid = true;
+    }
+    portEXIT_CRITICAL(&hal_pwm_lock);
+    if (held) {
+        return HAL_OK;
+    }
+#else
+    uint32_t cut_gen_a = a->cut_gen;
+    uint32_t cut_gen_b = b->cut_gen;
+    a->shadow_valid = false;
+    b->shadow_valid = false;
+    if (ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel_a, duty_a) != ESP_OK ||
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel_b, duty_b) != ESP_OK ||
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel_a) != ESP_OK ||
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel_b) != ESP_OK) {
+        return HAL_ERR_INVALID;
+    }
+    portENTER_CRITICAL(&hal_pwm_lock);
+    a->duty = duty_a;
+    b->duty = duty_b;
+    a->shadow_valid = (a->cut_gen == cut_gen_a);
+    b->shadow_valid = (b->cut_gen == cut_gen_b);
+    if (a->cut_latched) {
+        hal_pwm_idle_ll(channel_a);
+    }
+    if (b->cut_latched) {
+        hal_pwm_idle_ll(channel_b);
+    }
+    portEXIT_CRITICAL(&hal_pwm_lock);
+#endif
+    a->stats.writes++;
+    b->stats.writes++;
     return HAL_OK;
 }
 
 /**
- * @brief Stops the global HAL tick timer.
+ * @brief Commits a frame of PWM duties, writing only changed channels.
  *
  * @details
- * Cancels and deletes the tick timer if it is active.
+ * Each channel in frame->mask is diffed against its shadow; unchanged
+ * channels cost no driver call. All channels are attempted even if one
+ * fails.
  *
- * Postconditions:
- * - The global tick timer is inactive.
+ * Preconditions:
+ * - Every channel in frame->mask is configured via hal_pwm_init().
  *
  * Side effects:
- * - Deletes the underlying ESP timer.
+ * - Updates LEDC duty for channels whose value changed.
  *
- * @return HAL_OK on success.
+ * Error handling:
+ * - Returns the last failing status; channels after a failure are still
+ *   written.
+ *
+ * @param frame Duties to apply. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid frame or driver
+ *         failure, HAL_ERR_UNSUPPORTED if a channel is not configured.
  */
-hal_status_t hal_tick_stop(void) {
-    if (!hal_tick_timer) {
-        return HAL_OK;
+hal_status_t hal_pwm_commit(const hal_pwm_frame_t *frame) {
+    if (frame == NULL || (frame->mask >> HAL_PWM_FRAME_CHANNELS) != 0) {
+        return HAL_ERR_INVALID;
     }
-    esp_timer_stop(hal_tick_timer);
-    esp_timer_delete(hal_tick_timer);
-    hal_tick_timer = NULL;
-    hal_tick_callback = NULL;
-    hal_tick_user_data = NULL;
-    return HAL_OK;
-}
-
-static ledc_timer_t hal_pwm_select_timer(int pin) {
-    if (pin == BOARD_GPIO_MOTOR_IN1 || pin == BOARD_GPIO_MOTOR_IN2) {
-        return LEDC_TIMER_1;
+    hal_status_t status = HAL_OK;
+    for (uint32_t pending = frame->mask; pending != 0; pending &= pending - 1U) {
+        int channel = __builtin_ctz(pending);
+        hal_status_t result = hal_pwm_channels[channel].configured
+                                  ? hal_pwm_write(channel, frame->duty[channel])
+                                  : HAL_ERR_UNSUPPORTED;
+        if (result != HAL_OK) {
+            status = result;
+        }
     }
-    return LEDC_TIMER_0;
+    return status;
 }
 
-static ledc_timer_bit_t hal_pwm_bits_to_ledc(uint32_t bits) {
-    if (bits < 1) {
-        bits = 1;
-    }
-    if (bits >= LEDC_TIMER_BIT_MAX) {
-        bits = LEDC_TIMER_BIT_MAX - 1;
+/**
+ * @brief Copies the write accounting of a PWM channel.
+ *
+ * @param channel LEDC channel index.
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t hal_pwm_get_channel_stats(int channel, hal_pwm_channel_stats_t *stats) {
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX || stats == NULL) {
+        return HAL_ERR_INVALID;
     }
-    return (ledc_timer_bit_t)bits;
+    *stats = hal_pwm_channels[channel].stats;
+    return HAL_OK;
 }
 
-typedef struct {
-    bool configured;
-    int pin;
-    ledc_timer_t timer;
-    uint32_t duty_max;
-} hal_pwm_channel_t;
-
-static hal_pwm_channel_t hal_pwm_channels[LEDC_CHANNEL_MAX];
-static bool hal_pwm_timer_configured[LEDC_TIMER_MAX];
-static uint32_t hal_pwm_timer_freq[LEDC_TIMER_MAX];
-static uint32_t hal_pwm_timer_bits[LEDC_TIMER_MAX];
-
 /**
- * @brief Initializes a PWM channel for a GPIO pin.
+ * @brief Marks a channel's hardware fade as finished.
  *
  * @details
- * Configures the LEDC timer and channel for the requested frequency and
- * resolution. Motor pins are placed on a separate LEDC timer to preserve
- * frequency settings.
- *
- * Preconditions:
- * - channel must be in [0, LEDC_CHANNEL_MAX).
- * - pin must be a valid output-capable GPIO.
+ * Runs from the LEDC fade interrupt when the fade reaches its target duty.
  *
- * Postconditions:
- * - The PWM channel is configured and ready for duty updates.
+ * @param param Fade event reported by the driver.
+ * @param user_arg Unused.
+ * @return False; no task needs to be woken.
+ */
+static bool hal_pwm_fade_end_cb(const ledc_cb_param_t *param, void *user_arg) {
+    (void)user_arg;
+    if (param->event == LEDC_FADE_END_EVT && param->channel < LEDC_CHANNEL_MAX) {
+        hal_pwm_channels[param->channel].fading = false;
+    }
+    return false;
+}
+
+/**
+ * @brief Installs the LEDC fade service and the channel's fade-end callback.
  *
- * Side effects:
- * - Allocates/updates LEDC timer and channel configuration.
+ * @details
+ * Both are set up on first use so boards that never fade do not pay for the
+ * LEDC interrupt.
  *
- * @param channel LEDC channel index.
- * @param pin GPIO number to drive with PWM.
- * @param freq_hz PWM frequency in Hertz.
- * @param duty_resolution_bits Duty resolution in bits.
- * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure.
+ * @param channel Configured LEDC channel index.
+ * @return HAL_OK on success, HAL_ERR_UNSUPPORTED if the service is unavailable.
  */
-hal_status_t hal_pwm_init(int channel, int pin, uint32_t freq_hz,
-                          uint32_t duty_resolution_bits) {
-    if (channel < 0 || channel >= LEDC_CHANNEL_MAX) {
-        return HAL_ERR_INVALID;
-    }
-    if (!hal_gpio_output_valid(pin)) {
-        return HAL_ERR_INVALID;
+static hal_status_t hal_pwm_fade_prepare(int channel) {
+    if (!hal_pwm_fade_installed) {
+        esp_err_t err = ledc_fade_func_install(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            return HAL_ERR_UNSUPPORTED;
+        }
+        hal_pwm_fade_installed = true;
     }
-
-    ledc_timer_t timer = hal_pwm_select_timer(pin);
-    ledc_timer_bit_t res = hal_pwm_bits_to_ledc(duty_resolution_bits);
-
-    if (!hal_pwm_timer_configured[timer] ||
-        hal_pwm_timer_freq[timer] != freq_hz ||
-        hal_pwm_timer_bits[timer] != duty_resolution_bits) {
-        ledc_timer_config_t timer_cfg = {
-            .speed_mode = LEDC_LOW_SPEED_MODE,
-            .timer_num = timer,
-            .duty_resolution = res,
-            .freq_hz = freq_hz,
-            .clk_cfg = LEDC_AUTO_CLK,
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    if (!ch->fade_cb_registered) {
+        ledc_cbs_t cbs = {
+            .fade_cb = hal_pwm_fade_end_cb,
         };
-        if (ledc_timer_config(&timer_cfg) != ESP_OK) {
-            return HAL_ERR_INVALID;
+        if (ledc_cb_register(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, &cbs, NULL) != ESP_OK) {
+            return HAL_ERR_UNSUPPORTED;
         }
-        hal_pwm_timer_configured[timer] = true;
-        hal_pwm_timer_freq[timer] = freq_hz;
-        hal_pwm_timer_bits[timer] = duty_resolution_bits;
-    }
-
-    ledc_channel_config_t channel_cfg = {
-        .gpio_num = pin,
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .channel = (ledc_channel_t)channel,
-        .timer_sel = timer,
-        .duty = 0,
-        .hpoint = 0,
-    };
-    if (ledc_channel_config(&channel_cfg) != ESP_OK) {
-        return HAL_ERR_INVALID;
-    }
-
-    hal_pwm_channels[channel].configured = true;
-    hal_pwm_channels[channel].pin = pin;
-    hal_pwm_channels[channel].timer = timer;
-    if (duty_resolution_bits >= 31) {
-        hal_pwm_channels[channel].duty_max = 0xFFFFFFFFU;
-    } else {
-        hal_pwm_channels[channel].duty_max = (1U << duty_resolution_bits) - 1U;
+        ch->fade_cb_registered = true;
     }
-
     return HAL_OK;
 }
 
 /**
- * @brief Updates the PWM duty for a configured channel.
+ * @brief Starts a linear hardware fade from the current duty to a target.
  *
  * @details
- * Clamps duty to the configured maximum for the channel before updating.
+ * The LEDC fade engine steps the duty without CPU involvement and raises an
+ * interrupt at the end. Only one fade may run per channel; the caller polls
+ * hal_pwm_fade_active() before chaining the next one. The duty shadow is
+ * invalidated for the duration, so the next hal_pwm_set_duty() or frame
+ * commit always reaches the hardware and cancels the fade.
  *
  * Preconditions:
  * - channel must be configured via hal_pwm_init().
  *
  * Side effects:
- * - Updates LEDC duty and commits it to hardware.
+ * - Installs the LEDC fade service on first use.
+ * - Starts the fade on the channel.
  *
  * @param channel LEDC channel index.
- * @param duty Duty value in channel resolution units.
- * @return HAL_OK on success, HAL_ERR_INVALID on invalid params or failure,
- *         HAL_ERR_UNSUPPORTED if the channel is not configured.
+ * @param duty Target duty in channel resolution units; clamped to duty_max.
+ * @param time_ms Fade duration in milliseconds; 0 writes the duty at once.
+ * @return HAL_OK on success, HAL_ERR_BUSY while a fade is running,
+ *         HAL_ERR_UNSUPPORTED if the channel is not configured or the fade
+ *         service is unavailable, HAL_ERR_INVALID on invalid params or
+ *         driver failure.
  */
-hal_status_t hal_pwm_set_duty(int channel, uint32_t duty) {
+hal_status_t hal_pwm_fade_start(int channel, uint32_t duty, uint32_t time_ms) {
     if (channel < 0 || channel >= LEDC_CHANNEL_MAX) {
         return HAL_ERR_INVALID;
     }
-    if (!hal_pwm_channels[channel].configured) {
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    if (!ch->configured) {
         return HAL_ERR_UNSUPPORTED;
     }
-
-    uint32_t max_duty = hal_pwm_channels[channel].duty_max;
-    if (duty > max_duty) {
-        duty = max_duty;
+    if (time_ms == 0) {
+        return hal_pwm_write(channel, duty);
     }
-
-    if (ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, duty) != ESP_OK) {
-        return HAL_ERR_INVALID;
+    if (ch->fading) {
+        return HAL_ERR_BUSY;
+    }
+    if (hal_pwm_fade_prepare(channel) != HAL_OK) {
+        return HAL_ERR_UNSUPPORTED;
+    }
+    if (duty > ch->duty_max) {
+        duty = ch->duty_max;
     }
-    if (ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel) != ESP_OK) {
+
+    portENTER_CRITICAL(&hal_pwm_lock);
+    ch->fading = true;
+    ch->shadow_valid = false;
+    ch->duty = duty;
+    portEXIT_CRITICAL(&hal_pwm_lock);
+    if (ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, duty,
+                                     time_ms, LEDC_FADE_NO_WAIT) != ESP_OK) {
+        ch->fading = false;
         return HAL_ERR_INVALID;
     }
+    ch->stats.fades++;
     return HAL_OK;
 }
 
+/**
+ * @brief Reports whether a hardware fade is still running on a channel.
+ *
+ * @param channel LEDC channel index.
+ * @return True between hal_pwm_fade_start() and the fade-end interrupt.
+ */
+bool hal_pwm_fade_active(int channel) {
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX) {
+        return false;
+    }
+    return hal_pwm_channels[channel].fading;
+}
+
+/**
+ * @brief Forces a PWM channel output idle from interrupt context.
+ *
+ * @details
+ * Uses the LEDC low-level layer, which is inlined and therefore safe in an
+ * IRAM ISR, instead of the driver calls that take locks. Disabling the
+ * signal output drives the idle level at once rather than at the end of the
+ * PWM period. The channel is latched idle until the cut is acknowledged and
+ * its duty shadow is invalidated, so the first request after that
+ * re-enables the output. Unconfigured channels are ignored.
+ *
+ * @param channel LEDC channel index.
+ */
+static void IRAM_ATTR hal_pwm_cut_isr(int channel) {
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX || !hal_pwm_channels[channel].configured) {
+        return;
+    }
+    portENTER_CRITICAL_ISR(&hal_pwm_lock);
+    hal_pwm_channels[channel].cut_gen++;
+    hal_pwm_channels[channel].cut_latched = true;
+    hal_pwm_channels[channel].shadow_valid = false;
+    portEXIT_CRITICAL_ISR(&hal_pwm_lock);
+    hal_pwm_idle_ll(channel);
+}
+
 /**
  * @brief Initializes UART0 with the configured pins.
  *
@@ -788,6 +2468,270 @@ static void hal_selftest_tick_cb(void *ctx) {
     volatile uint32_t *count = (volatile uint32_t *)ctx;
     (*count)++;
 }
+
+/**
+ * @brief Checks tick statistics bookkeeping against synthetic timestamps.
+ *
+ * @details
+ * Feeds a 1 kHz sequence containing one late tick, one bunched tick, and one
+ * overrunning callback, then verifies the recorded extremes and histogram.
+ *
+ * @return True when every check passes.
+ */
+static bool hal_selftest_tick_stats(void) {
+    static const int64_t starts_us[] = { 0, 1000, 2000, 3300, 3700, 4700, 5700 };
+    static const uint32_t durations_us[] = { 40, 40, 40, 40, 1200, 40, 40 };
+    hal_tick_stats_t stats;
+
+    hal_tick_stats_init(&stats, 1000);
+    for (size_t i = 0; i < sizeof(starts_us) / sizeof(starts_us[0]); i++) {
+        hal_tick_stats_record(&stats, starts_us[i], starts_us[i] + durations_us[i]);
+    }
+
+    bool ok = true;
+    ok = ok && stats.ticks == 7 && stats.periods == 6;
+    ok = ok && stats.period_err_max_us == 300 && stats.period_err_min_us == -600;
+    ok = ok && stats.period_err_worst_us == 600;
+    ok = ok && stats.callback_max_us == 1200 && stats.overruns == 1;
+    ok = ok && stats.late_ticks == 0;
+    ok = ok && stats.hist[0] == 4 && stats.hist[6] == 2;
+    return ok;
+}
+
+/**
+ * @brief Checks the timer wheel with many concurrent timers.
+ *
+ * @details
+ * Runs 200 staggered one-shot timers, a 2.5 ms periodic timer, and a timer
+ * stopped before expiry, all multiplexed onto the single wheel esp_timer.
+ *
+ * @return True when every check passes.
+ */
+static bool hal_selftest_timer_wheel(void) {
+    enum { ONESHOTS = 200, PERIODIC_ID = ONESHOTS, STOPPED_ID = ONESHOTS + 1 };
+    volatile uint32_t oneshot_hits = 0;
+    volatile uint32_t periodic_hits = 0;
+    volatile uint32_t stopped_hits = 0;
+
+    for (int i = 0; i < ONESHOTS; i++) {
+        hal_timer_start_us(i, 1000U + (uint32_t)i * 250U, HAL_TIMER_ONESHOT,
+                           hal_selftest_tick_cb, (void *)&oneshot_hits);
+    }
+    hal_timer_start_us(PERIODIC_ID, 2500, HAL_TIMER_PERIODIC,
+                       hal_selftest_tick_cb, (void *)&periodic_hits);
+    hal_timer_start_us(STOPPED_ID, 5000, HAL_TIMER_ONESHOT,
+                       hal_selftest_tick_cb, (void *)&stopped_hits);
+    hal_timer_stop(STOPPED_ID);
+
+    hal_delay_ms(100);
+    hal_timer_stop(PERIODIC_ID);
+    for (int i = 0; i < ONESHOTS; i++) {
+        hal_timer_stop(i);
+    }
+
+    ESP_LOGI(TAG, "Timer wheel one-shot=%u periodic=%u stopped=%u",
+             (unsigned)oneshot_hits, (unsigned)periodic_hits, (unsigned)stopped_hits);
+    return oneshot_hits == ONESHOTS && periodic_hits >= 38 && periodic_hits <= 40 &&
+           stopped_hits == 0;
+}
+
+/**
+ * @brief Checks hal_gpio_write_mask() validation and set/clear writes.
+ *
+ * @details
+ * Rejected masks must leave GPIO_OUT untouched; a valid set then clear of
+ * the pin must show up in GPIO_OUT.
+ *
+ * @param pin Output-configured GPIO to drive.
+ * @return True when every check passes.
+ */
+static bool hal_selftest_gpio_write_mask(int pin) {
+    hal_gpio_mask_t bit = HAL_GPIO_BIT(pin);
+    hal_gpio_mask_t no_output = ~(hal_gpio_mask_t)SOC_GPIO_VALID_OUTPUT_GPIO_MASK;
+    no_output &= ~no_output + 1U;
+    if (bit == 0 || hal_gpio_config_output(pin, HAL_GPIO_LOW) != HAL_OK) {
+        return false;
+    }
+
+    bool ok = hal_gpio_write_mask(bit, bit) == HAL_ERR_INVALID &&
+              (REG_READ(GPIO_OUT_REG) & bit) == 0;
+    ok = ok && (no_output == 0 ||
+                (hal_gpio_write_mask(bit | no_output, 0) == HAL_ERR_INVALID &&
+                 (REG_READ(GPIO_OUT_REG) & bit) == 0));
+    ok = ok && hal_gpio_write_mask(bit, 0) == HAL_OK && (REG_READ(GPIO_OUT_REG) & bit) != 0;
+    ok = ok && hal_gpio_write_mask(0, bit) == HAL_OK && (REG_READ(GPIO_OUT_REG) & bit) == 0;
+    return ok;
+}
+
+/**
+ * @brief Checks edge ring overflow and the one-shot PWM cut.
+ *
+ * @details
+ * Invokes the edge ISR directly on the opto pin to overfill the ring, then
+ * arms a cut for the current level and verifies it fires exactly once.
+ *
+ * @return True when every check passes.
+ */
+static bool hal_selftest_gpio_edge(void) {
+    enum { EXTRA = 3 };
+    int pin = BOARD_GPIO_OPTO_INT;
+    if (hal_gpio_config_input(pin, HAL_GPIO_PULL_NONE) != HAL_OK ||
+        hal_gpio_edge_enable(pin, HAL_GPIO_EDGE_BOTH) != HAL_OK) {
+        return false;
+    }
+    hal_gpio_edge_slot_t *slot = hal_gpio_edge_find(pin);
+    for (int i = 0; i < HAL_GPIO_EDGE_RING_LEN + EXTRA; i++) {
+        hal_gpio_edge_isr(slot);
+    }
+
+    bool ok = hal_gpio_edge_dropped(pin) == EXTRA;
+    hal_gpio_edge_event_t event;
+    int64_t last_us = 0;
+    uint32_t popped = 0;
+    while (hal_gpio_edge_pop(pin, &event)) {
+        ok = ok && event.time_us >= last_us;
+        last_us = event.time_us;
+        popped++;
+    }
+    ok = ok && popped == HAL_GPIO_EDGE_RING_LEN;
+
+    hal_gpio_edge_arm_pwm_cut(pin, hal_gpio_read(pin), 1U);
+    hal_gpio_edge_isr(slot);
+    hal_gpio_edge_isr(slot);
+    hal_gpio_edge_cut_t cut;
+    ok = ok && hal_gpio_edge_take_cut(pin, &cut) && cut.edge_us > 0;
+    ok = ok && !hal_gpio_edge_take_cut(pin, NULL);
+
+    hal_gpio_edge_disable(pin);
+    return ok;
+}
+
+/**
+ * @brief Checks that an ISR cut holds a channel idle until acknowledged.
+ *
+ * @details
+ * A frame duty written after the cut must not reach the channel; collecting
+ * the cut, or writing a duty of 0, must let the next duty through.
+ *
+ * @param channel Configured LEDC channel to cut; left at duty 0.
+ * @return True when every check passes.
+ */
+static bool hal_selftest_pwm_cut(int channel) {
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    uint32_t half = 1U << (HAL_PWM_DUTY_RES_BITS - 1);
+    uint32_t quarter = half >> 1;
+    bool ok = hal_pwm_set_duty(channel, half) == HAL_OK;
+    hal_pwm_cut_isr(channel);
+    ok = ok && hal_pwm_set_duty(channel, quarter) == HAL_OK;
+    ok = ok && ch->cut_latched && !ch->shadow_valid && ch->duty == half;
+
+    hal_pwm_cut_release(1U << channel);
+    ok = ok && hal_pwm_set_duty(channel, quarter) == HAL_OK && ch->shadow_valid &&
+         ch->duty == quarter;
+
+    hal_pwm_cut_isr(channel);
+    ok = ok && hal_pwm_set_duty(channel, 0) == HAL_OK && !ch->cut_latched && ch->shadow_valid;
+    return ok;
+}
+
+/**
+ * @brief Checks the paired channel update.
+ *
+ * @details
+ * Reverses a pair of LED channels with paired updates, as the motor FSM
+ * does with the bridge inputs, and checks that each change writes both
+ * channels, a repeat writes neither, and a pair spanning two LEDC timers
+ * is refused. The motor bridge is never driven: one motor channel is only
+ * configured, at duty 0, to have a channel on the other timer. A cut on
+ * one channel must hold both until it is acknowledged.
+ *
+ * @return True when every check passes.
+ */
+static bool hal_selftest_pwm_pair(void) {
+    enum { IN1 = 2, IN2 = 3, MOTOR = 5 };
+    uint32_t half = 1U << (HAL_PWM_DUTY_RES_BITS - 1);
+    if (hal_pwm_init(IN1, BOARD_GPIO_LED2, HAL_PWM_LED_FREQ_HZ, HAL_PWM_DUTY_RES_BITS) != HAL_OK ||
+        hal_pwm_init(IN2, BOARD_GPIO_LED3, HAL_PWM_LED_FREQ_HZ, HAL_PWM_DUTY_RES_BITS) != HAL_OK ||
+        hal_pwm_init(MOTOR, BOARD_GPIO_MOTOR_IN2, HAL_PWM_MOTOR_FREQ_HZ,
+                     HAL_PWM_DUTY_RES_BITS) != HAL_OK) {
+        return false;
+    }
+    hal_pwm_channel_stats_t before;
+    hal_pwm_channel_stats_t after;
+    hal_pwm_get_channel_stats(IN1, &before);
+    bool ok = hal_pwm_set_duty_pair(IN1, 0, IN2, half) == HAL_OK;
+    ok = ok && hal_pwm_set_duty_pair(IN1, half, IN2, 0) == HAL_OK;
+    ok = ok && hal_pwm_set_duty_pair(IN1, half, IN2, 0) == HAL_OK;
+    hal_pwm_get_channel_stats(IN1, &after);
+    ok = ok && after.requests - before.requests == 3 && after.writes - before.writes == 2;
+    ok = ok && hal_pwm_channels[IN2].duty == 0 && hal_pwm_channels[IN1].duty == half;
+    ok = ok && hal_pwm_set_duty_pair(MOTOR, 0, IN2, 0) == HAL_ERR_INVALID;
+
+    hal_pwm_cut_isr(IN1);
+    ok = ok && hal_pwm_set_duty_pair(IN1, 0, IN2, half) == HAL_OK &&
+         !hal_pwm_channels[IN1].cut_latched;
+    hal_pwm_cut_isr(IN2);
+    ok = ok && hal_pwm_set_duty_pair(IN1, half, IN2, half) == HAL_OK &&
+         hal_pwm_channels[IN1].duty == 0 && !hal_pwm_channels[IN2].shadow_valid;
+    hal_pwm_cut_release(1U << IN2);
+    hal_pwm_set_duty_pair(IN1, 0, IN2, 0);
+    return ok;
+}
+
+/**
+ * @brief Finds a configured PWM channel to benchmark.
+ *
+ * @return Lowest configured frame channel, or -1 if there is none.
+ */
+static int hal_selftest_pwm_bench_channel(void) {
+    for (int channel = 0; channel < HAL_PWM_FRAME_CHANNELS; channel++) {
+        if (hal_pwm_channels[channel].configured) {
+            return channel;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Measures CPU cycles per duty update on the driver and fast paths.
+ *
+ * @details
+ * Both loops bypass the shadow and write a changing duty every round, so
+ * each iteration is a full update. The fast path is timed with the PWM
+ * critical section it runs under in hal_pwm_write(). The counts are only
+ * meaningful on silicon: QEMU does not model LEDC register access costs.
+ *
+ * @param channel Configured LEDC channel to exercise; left at duty 0.
+ * @param driver_cycles Output: mean cycles per driver-path update.
+ * @param fast_cycles Output: mean cycles per fast-path update.
+ * @return True when the fast path is cheaper.
+ */
+static bool hal_selftest_pwm_bench(int channel, uint32_t *driver_cycles,
+                                   uint32_t *fast_cycles) {
+    enum { ROUNDS = 64 };
+    hal_pwm_channel_t *ch = &hal_pwm_channels[channel];
+    if (!ch->configured) {
+        return false;
+    }
+
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        hal_pwm_update_driver(channel, i & ch->duty_max);
+    }
+    *driver_cycles = (uint32_t)(esp_cpu_get_cycle_count() - start) / ROUNDS;
+
+    start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        portENTER_CRITICAL(&hal_pwm_lock);
+        hal_pwm_update_ll(channel, i & ch->duty_max);
+        portEXIT_CRITICAL(&hal_pwm_lock);
+    }
+    *fast_cycles = (uint32_t)(esp_cpu_get_cycle_count() - start) / ROUNDS;
+
+    ch->shadow_valid = false;
+    hal_pwm_set_duty(channel, 0);
+    return *fast_cycles < *driver_cycles;
+}
 #endif
 
 /**
@@ -1003,16 +2947,78 @@ void hal_selftest_run(void) {
     ESP_LOGI(TAG, "Button FWD=%d REV=%d",
              hal_gpio_read(BOARD_GPIO_BUTTON_FWD),
              hal_gpio_read(BOARD_GPIO_BUTTON_REV));
-
-    volatile uint32_t tick_count = 0;
-    hal_tick_start(1000, hal_selftest_tick_cb, (void *)&tick_count);
-    hal_delay_ms(1100);
-    hal_tick_stop();
-    ESP_LOGI(TAG, "Tick count (1s): %u", (unsigned)tick_count);
+    hal_gpio_mask_t button_mask = HAL_GPIO_BIT(BOARD_GPIO_BUTTON_FWD) |
+                                  HAL_GPIO_BIT(BOARD_GPIO_BUTTON_REV);
+    hal_gpio_mask_t button_levels = hal_gpio_read_mask(button_mask);
+    bool mask_ok = (button_levels & ~button_mask) == 0 &&
+                   ((button_levels & HAL_GPIO_BIT(BOARD_GPIO_BUTTON_FWD)) != 0) ==
+                       (hal_gpio_read(BOARD_GPIO_BUTTON_FWD) == HAL_GPIO_HIGH) &&
+                   ((button_levels & HAL_GPIO_BIT(BOARD_GPIO_BUTTON_REV)) != 0) ==
+                       (hal_gpio_read(BOARD_GPIO_BUTTON_REV) == HAL_GPIO_HIGH);
+    ESP_LOGI(TAG, "GPIO read mask 0x%08x: %s", (unsigned)button_levels,
+             mask_ok ? "PASS" : "FAIL");
+
+    ESP_LOGI(TAG, "Tick stats synthetic: %s", hal_selftest_tick_stats() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Timer wheel: %s", hal_selftest_timer_wheel() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "GPIO edge capture: %s", hal_selftest_gpio_edge() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "GPIO write mask: %s",
+             hal_selftest_gpio_write_mask(BOARD_GPIO_LED3) ? "PASS" : "FAIL");
+
+    static const char *const tick_mode_names[] = { "timer-task", "task", "isr" };
+    for (int mode = HAL_TICK_MODE_TIMER_TASK; mode <= HAL_TICK_MODE_ISR; mode++) {
+        volatile uint32_t tick_count = 0;
+        hal_tick_stats_t tick_stats;
+        hal_tick_config_t tick_cfg = {
+            .mode = (hal_tick_mode_t)mode,
+            .task_priority = HAL_TICK_TASK_PRIORITY,
+            .task_stack_bytes = HAL_TICK_TASK_STACK_BYTES,
+        };
+        hal_tick_start_ex(1000, &tick_cfg, hal_selftest_tick_cb, (void *)&tick_count);
+        hal_delay_ms(1100);
+        hal_tick_get_stats(&tick_stats);
+        hal_tick_stop();
+        ESP_LOGI(TAG, "Tick [%s] count (1s): %u", tick_mode_names[mode], (unsigned)tick_count);
+        ESP_LOGI(TAG, "Tick [%s] jitter min=%ld max=%ld us, callback max=%u us, "
+                 "latency max=%u us, overruns=%u late=%u",
+                 tick_mode_names[mode],
+                 (long)tick_stats.period_err_min_us, (long)tick_stats.period_err_max_us,
+                 (unsigned)tick_stats.callback_max_us, (unsigned)tick_stats.latency_max_us,
+                 (unsigned)tick_stats.overruns, (unsigned)tick_stats.late_ticks);
+    }
 
     hal_pwm_init(0, BOARD_GPIO_LED0, HAL_PWM_LED_FREQ_HZ, HAL_PWM_DUTY_RES_BITS);
     hal_pwm_set_duty(0, (1U << (HAL_PWM_DUTY_RES_BITS - 1)));
 
+    hal_pwm_channel_stats_t pwm_before;
+    hal_pwm_channel_stats_t pwm_after;
+    hal_pwm_frame_t pwm_frame = { .mask = 1U << 3 };
+    pwm_frame.duty[3] = 1U << (HAL_PWM_DUTY_RES_BITS - 2);
+    hal_pwm_init(3, BOARD_GPIO_LED3, HAL_PWM_LED_FREQ_HZ, HAL_PWM_DUTY_RES_BITS);
+    hal_pwm_get_channel_stats(3, &pwm_before);
+    hal_pwm_commit(&pwm_frame);
+    hal_pwm_commit(&pwm_frame);
+    hal_pwm_set_duty(3, pwm_frame.duty[3]);
+    hal_pwm_get_channel_stats(3, &pwm_after);
+    hal_pwm_set_duty(3, 0);
+    ESP_LOGI(TAG, "PWM shadow: %s",
+             (pwm_after.requests - pwm_before.requests == 3 &&
+              pwm_after.writes - pwm_before.writes == 1) ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "PWM cut latch: %s", hal_selftest_pwm_cut(3) ? "PASS" : "FAIL");
+
+    uint32_t driver_cycles = 0;
+    uint32_t fast_cycles = 0;
+    ESP_LOGI(TAG, "PWM pair: %s", hal_selftest_pwm_pair() ? "PASS" : "FAIL");
+
+    int bench_channel = hal_selftest_pwm_bench_channel();
+    if (bench_channel < 0) {
+        ESP_LOGI(TAG, "PWM update cycles: SKIP (no PWM channel configured)");
+    } else {
+        bool bench_ok = hal_selftest_pwm_bench(bench_channel, &driver_cycles, &fast_cycles);
+        ESP_LOGI(TAG, "PWM update cycles ch%d driver=%u fast=%u (%s path active): %s",
+                 bench_channel, (unsigned)driver_cycles, (unsigned)fast_cycles,
+                 HAL_PWM_FAST_PATH ? "fast" : "driver", bench_ok ? "PASS" : "FAIL");
+    }
+
     if (hal_uart_init(UART_NUM_0, HAL_UART0_BAUD_DEFAULT) == HAL_OK) {
         const char banner[] = "HAL UART0 ready\n";
         hal_uart_write(UART_NUM_0, (const uint8_t *)banner, sizeof(banner) - 1);
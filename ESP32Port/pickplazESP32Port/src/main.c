@@ -48,7 +48,8 @@ static const char *TAG = "pickplaz";
  * - Errors are reported via logs in lower layers; this function does not
  *   return error codes.
  *
- * @note The self-test runs only when HAL_SELFTEST is defined.
+ * @note The HAL and application self-tests run only when HAL_SELFTEST is
+ *       defined.
  *
  * @par Inputs/Outputs
  * | Item   | Description |
@@ -62,6 +63,7 @@ void app_main(void) {
     hal_init();
 #ifdef HAL_SELFTEST
     hal_selftest_run();
+    pickplaz_app_selftest_run();
 #endif
     pickplaz_app_init();
     pickplaz_app_start();
@@ -13,12 +13,20 @@
  *
  * @details
  * Owns the 1 kHz application tick, translates button/opto/feed inputs into
- * state transitions, and drives LED/motor outputs through the HAL. This
- * module is platform-agnostic and relies on board pin mappings defined in
- * `board_pins.h` plus optional overrides in `hal_config.h`.
+ * state transitions, and drives LED/motor outputs through the HAL. Work is
+ * split into static rate groups so LED animation and bookkeeping do not run
+ * at the control rate. Logic steps are scheduled against absolute
+ * microsecond deadlines from the HAL timebase, so delayed or missed tick
+ * callbacks are caught up by running the missed steps instead of stretching
+ * every counter-based timeout. This module is platform-agnostic and relies
+ * on board pin mappings defined in `board_pins.h` plus optional overrides
+ * in `hal_config.h`.
  *
  * Thread-safety:
- * - Not thread-safe; intended to run from a single periodic tick.
+ * - pickplaz_app_post_command() may be called from one host task other
+ *   than the tick; the command ring has a single producer.
+ * - Every other entry point runs from the tick context, or while the tick
+ *   is stopped, and is not thread-safe.
  */
 
 #include "pickplaz_app.h"
@@ -29,6 +37,15 @@
 #include "esp_log.h"
 #include "hal.h"
 #include "hal_config.h"
+#include "pickplaz_brake.h"
+#include "pickplaz_button.h"
+#include "pickplaz_event.h"
+#include "pickplaz_feed.h"
+#include "pickplaz_fsm.h"
+#include "pickplaz_model.h"
+#include "pickplaz_profile.h"
+#include "pickplaz_queue.h"
+#include "pickplaz_speed.h"
 
 static const char *TAG = "pickplaz_app";
 
@@ -49,39 +66,22 @@ extern const uint16_t sintab[256];
 enum app_constants {
     APP_PWM_STM32_MAX = 2048,
     APP_TICK_HZ = 1000,
+    APP_STEP_US = 1000000 / APP_TICK_HZ,
+    APP_CATCHUP_MAX_STEPS = 50,
+    APP_RESYNC_STEPS = 1000,
+    APP_RATE_LED_HZ = 250,
+    APP_RATE_FEED_LED_HZ = 50,
+    APP_RATE_STATS_HZ = 1,
     APP_SINE_LEN = 256,
     APP_SINE_SCALE = 8,
     APP_FEED_PULSE_MS = 500,
-    APP_BUTTON_CNT_MAX = 20,
-    APP_BUTTON_LONGPRESS = 400,
+    APP_BUTTON_ATTACK_US = 5000,
+    APP_BUTTON_RELEASE_US = 5000,
+    APP_BUTTON_LONG_US = 400000,
+    APP_BRAKE_GAP_AGE_US = 5000,
+    APP_WAKE_LINGER_STEPS = APP_TICK_HZ / APP_RATE_LED_HZ,
 };
 
-/**
- * @brief Represents a decoded feed input event.
- *
- * @details
- * The feed input is sampled at 1 kHz and converted into a short or long event
- * consumed by the application FSM.
- */
-typedef enum {
-    /** No feed event has been detected. */
-    FEED_none,
-    /** A short feed pulse was latched. */
-    FEED_short,
-    /** A long feed pulse was latched. */
-    FEED_long
-} feed_signal_t;
-
-/**
- * @brief Tracks the raw feed input level for pulse detection.
- */
-typedef enum {
-    /** Feed input is low; waiting for a rising edge. */
-    FEED_fsm_low,
-    /** Feed input is high; timing the pulse width. */
-    FEED_fsm_high
-} feed_fsm_t;
-
 /**
  * @brief Describes the motor control state machine.
  *
@@ -101,6 +101,21 @@ typedef enum {
     MOTOR_brake
 } motor_state_t;
 
+/**
+ * @brief How the H-bridge inputs carry a motor duty.
+ *
+ * @details
+ * Values match pickplaz_app_decay_t for the two decay modes.
+ */
+typedef enum {
+    /** PWM on the driven input, other input low: coasts in the off time. */
+    MOTOR_DRIVE_FAST_DECAY = PICKPLAZ_APP_DECAY_FAST,
+    /** Driven input high, other input inverted PWM: brakes in the off time. */
+    MOTOR_DRIVE_SLOW_DECAY = PICKPLAZ_APP_DECAY_SLOW,
+    /** Both inputs at the duty: shorts the windings, direction ignored. */
+    MOTOR_DRIVE_SHORT_BRAKE
+} motor_drive_t;
+
 /**
  * @brief Represents the main application state machine.
  *
@@ -124,37 +139,69 @@ typedef enum {
     /** Continuous forward motion while the forward request is held. */
     APP_free_forward,
     /** Continuous reverse motion while the reverse request is held. */
-    APP_free_backward
+    APP_free_backward,
+    /** Number of states in app_fsm_states. */
+    APP_STATE_COUNT
 } app_state_t;
 
 /**
- * @brief Represents the debounced button event for a single tick.
+ * @brief Halves of an increment whose durations are learned.
  */
 typedef enum {
-    /** No event this tick. */
-    BUTTON_none,
-    /** Short press released after debounce timing. */
-    BUTTON_short,
-    /** Long press released after exceeding the long-press threshold. */
-    BUTTON_long,
-    /** Button remains held; emitted while pressed. */
-    BUTTON_hold
-} button_event_t;
+    /** Steps from the start of a move until the opto leaves the index. */
+    APP_MODEL_LEAVE,
+    /** Steps from leaving the index until the next one is reached. */
+    APP_MODEL_TRAVEL,
+    /** Number of learned phases per direction. */
+    APP_MODEL_PHASES
+} app_model_phase_t;
 
 /**
- * @brief Holds debounce and press timing state for a button input.
+ * @brief Binds a button input to its debouncer.
  *
  * @details
- * The debounce counter saturates at APP_BUTTON_CNT_MAX and press counts are
- * measured in 1 kHz ticks.
+ * When edges is set the debouncer is fed from the HAL edge ring; otherwise
+ * it is fed from level changes in the per-step input snapshot.
  */
 typedef struct {
     int pin;
     bool active_low;
-    uint32_t cnt;
-    uint32_t press;
+    hal_gpio_mask_t bit;
+    bool edges;
+    pickplaz_button_t engine;
 } app_button_t;
 
+/**
+ * @brief Animation of one PWM LED: a sine wave or a fixed level.
+ */
+typedef struct {
+    bool wave;       /**< Animate with sintab instead of holding level. */
+    uint32_t offset; /**< sintab phase offset added to app_tick_ms. */
+    uint32_t level;  /**< STM32-style duty when wave is false. */
+} app_led_pattern_t;
+
+/**
+ * @brief Breakpoint of the piecewise-linear sintab approximation.
+ */
+typedef struct {
+    uint16_t index; /**< sintab index, i.e. milliseconds into the period. */
+    uint16_t value; /**< sintab value at index. */
+} app_led_knot_t;
+
+/**
+ * @brief Hardware fade sequencer state for one PWM LED.
+ *
+ * @details
+ * The LEDC fades linearly towards the next knot; the sequencer only runs
+ * again at due_ms to chain the following segment.
+ */
+typedef struct {
+    app_led_pattern_t pattern; /**< Pattern the running sequence was built for. */
+    bool pending;              /**< A segment must be armed at due_ms. */
+    uint32_t due_ms;           /**< app_tick_ms of the next segment boundary. */
+    uint32_t duty;             /**< Duty the hardware reaches at due_ms, HAL units. */
+} app_led_fade_t;
+
 /**
  * @brief PWM values for motor control modes.
  */
@@ -167,7 +214,39 @@ enum motor_pwm_constants {
 };
 
 /**
- * @brief PWM channel assignments for LEDs and motor outputs.
+ * @brief Declares one rate group of the static multi-rate scheduler.
+ *
+ * @details
+ * A group runs on logic steps where (step % divisor) == phase. Phases are
+ * chosen so that slower groups never share a step with each other, which
+ * keeps the worst-case step cost at the control group plus one slow group.
+ */
+typedef struct {
+    const char *name;
+    uint32_t rate_hz;
+    uint32_t divisor;
+    uint32_t phase;
+    void (*run)(void);
+} app_rate_group_t;
+
+#define APP_RATE_GROUP(group_name, hz, group_phase, fn) \
+    { .name = (group_name), .rate_hz = (hz), .divisor = APP_TICK_HZ / (hz), \
+      .phase = (group_phase), .run = (fn) }
+
+_Static_assert(APP_TICK_HZ % APP_RATE_LED_HZ == 0, "LED rate must divide the tick rate");
+_Static_assert(APP_TICK_HZ % APP_RATE_FEED_LED_HZ == 0, "Feed LED rate must divide the tick rate");
+_Static_assert(APP_TICK_HZ % APP_RATE_STATS_HZ == 0, "Stats rate must divide the tick rate");
+
+/**
+ * @brief HAL timer wheel slots owned by the application.
+ */
+enum app_timer_ids {
+    APP_TIMER_HEARTBEAT = 0,
+    APP_TIMER_WAKE = 1,
+};
+
+/**
+ * @brief PWM channel assignments of the board's default feeder.
  */
 enum app_pwm_channels {
     APP_PWM_LED0_CH = 0,
@@ -176,44 +255,249 @@ enum app_pwm_channels {
     APP_PWM_LED3_CH = 3,
     APP_PWM_MOTOR_IN1_CH = 4,
     APP_PWM_MOTOR_IN2_CH = 5,
+    APP_PWM_LED_COUNT = PICKPLAZ_APP_FEEDER_LEDS,
+};
+
+/**
+ * @brief sintab approximated by linear segments for the LEDC fade engine.
+ *
+ * @details
+ * 16 ms segments across the lobe, one fall to zero, and a hold; every
+ * interior knot is an exact sintab sample and the worst deviation is under
+ * 9 of 256.
+ */
+static const app_led_knot_t app_led_knots[] = {
+    { 0, 16 }, { 16, 58 }, { 32, 135 }, { 48, 219 }, { 64, 256 }, { 80, 219 },
+    { 96, 135 }, { 112, 58 }, { 128, 16 }, { 150, 0 }, { 234, 0 }, { 256, 16 },
+};
+
+#define APP_LED_KNOT_COUNT (sizeof(app_led_knots) / sizeof(app_led_knots[0]))
+
+/**
+ * @brief Default motor motion profile, in STM32 duty units.
+ *
+ * @details
+ * Starts at half duty, reaches full duty in about 45 ms along an S-curve,
+ * and runs the last 15% of a learned pocket at half duty so the brake
+ * starts from a lower speed. The approach is placed on the duty-summed
+ * position proxy, which unlike elapsed time does not shrink when a pocket
+ * is entered at speed.
+ */
+static const pickplaz_profile_config_t app_profile_default = {
+    .cruise_duty = APP_PWM_STM32_MAX,
+    .approach_duty = APP_PWM_STM32_MAX / 2,
+    .start_duty = APP_PWM_STM32_MAX / 2,
+    .accel = 40000,
+    .jerk = 2000000,
+    .approach_permille = 150,
+    .predictor = PICKPLAZ_PROFILE_PREDICT_PROGRESS,
+};
+
+/**
+ * @brief Default timing model tuning.
+ *
+ * @details
+ * Timeouts get four standard deviations plus 20 ms of headroom once four
+ * moves have been timed; online updates weigh each new move 1/8.
+ */
+static const pickplaz_model_config_t app_model_default = {
+    .sigma_k = 4,
+    .margin = 20,
+    .ema_shift = 3,
+    .min_samples = 4,
+};
+
+/**
+ * @brief Default speed loop: disabled, so the cruise duty stays open loop.
+ *
+ * @details
+ * A feeder is put in closed loop with pickplaz_app_set_speed() once its
+ * index gap setpoint is known.
+ */
+static const pickplaz_speed_config_t app_speed_default = {
+    .setpoint_us = 0,
+    .kp = 512,
+    .ki = 256,
+    .min_duty = APP_PWM_STM32_MAX / 8,
+    .max_duty = APP_PWM_STM32_MAX,
+    .open_duty = APP_PWM_STM32_MAX,
+    .timeout_us = 600000,
 };
 
-static app_button_t button_forward = {
-    .pin = BOARD_GPIO_BUTTON_FWD,
-    .active_low = BOARD_BUTTON_ACTIVE_LOW,
-    .cnt = 0,
-    .press = 0,
+/**
+ * @brief Default brake: reverse at the last driven duty for 10 ticks.
+ *
+ * @details
+ * 10 ticks is what the original firmware's brake held for: it loaded 8 and
+ * released the bridge two idle ticks later. The adaptive settings only
+ * take effect once pickplaz_app_set_brake() selects PICKPLAZ_BRAKE_PLUG or
+ * PICKPLAZ_BRAKE_SHORT.
+ */
+static const pickplaz_brake_config_t app_brake_default = {
+    .mode = PICKPLAZ_BRAKE_FIXED,
+    .fixed_ticks = 10,
+    .target_ticks = 4,
+    .min_duty = APP_PWM_STM32_MAX / 8,
+    .max_duty = APP_PWM_STM32_MAX,
+    .max_ticks = 40,
+    .plug_decel = 1600,
+    .short_decel = 400,
+    .settle_ticks = 100,
+    .index_permille = 250,
 };
 
-static app_button_t button_backward = {
-    .pin = BOARD_GPIO_BUTTON_REV,
-    .active_low = BOARD_BUTTON_ACTIVE_LOW,
-    .cnt = 0,
-    .press = 0,
+/**
+ * @brief One feeder driven by this controller.
+ *
+ * @details
+ * Holds everything that used to be per-firmware state on the STM32: the
+ * two FSMs, the motor control loops, input decoders, LED sequencers, and
+ * the pin and channel map they drive. Fields read or written by every
+ * control step come first and the statistics and map last, so the control
+ * group's pass over app_feeders walks each instance front to back.
+ */
+typedef struct {
+    /** Application FSM; the step timer is fsm.timer. ctx points back here. */
+    pickplaz_fsm_t fsm;
+    motor_state_t motor_state;
+    int32_t motor_target;
+    /** Profiled duty derived from motor_target; the motor FSM drives this. */
+    int32_t motor_command;
+    uint32_t motor_timer;
+    uint32_t motor_last_pwm;
+    bool motor_last_forward;
+    /** The move tracked by motor_profile started at an index and may be learned. */
+    bool motor_move_learn;
+    /** Both motor inputs are configured and committed as one latched pair. */
+    bool motor_paired;
+    /** True when opto transitions are timestamped by the HAL edge interrupt. */
+    bool opto_edges;
+    /** Mirrors whether the HAL has an ISR motor cut armed on the next index edge. */
+    bool opto_cut_armed;
+    bool feed_edges;
+    bool feed_led_trigger;
+    uint32_t opto_is_indexed;
+    /** Pockets left in the running increment, the current one included. */
+    uint32_t move_pockets;
+    /** The running increment started from idle on an index, so its timing may be sampled. */
+    bool move_from_rest;
+    /** A calibration run is feeding moves through the request queue. */
+    bool calibrating;
+    uint32_t feed_led_counter;
+    uint32_t forward_continuous_rq;
+    uint32_t backward_continuous_rq;
+    /** Decay mode per motion phase, indexed by pickplaz_app_phase_t. */
+    pickplaz_app_decay_t motor_decay[PICKPLAZ_APP_PHASE_COUNT];
+    app_button_t button_forward;
+    app_button_t button_backward;
+    /** Feed pulses, button presses, and host commands waiting for a move. */
+    pickplaz_queue_t requests;
+    pickplaz_feed_decoder_t feed_decoder;
+    pickplaz_profile_t motor_profile;
+    /** Cruise duty regulated from the opto index gap. */
+    pickplaz_speed_t motor_speed;
+    pickplaz_brake_t motor_brake;
+
+    app_led_fade_t led_fades[APP_PWM_LED_COUNT];
+    bool opto_has_index;
+    int64_t opto_index_us;
+    pickplaz_app_opto_stats_t opto_stats;
+    uint32_t queue_latency_last_us;
+    uint32_t queue_latency_max_us;
+    /** Learned increment durations, indexed by [forward][app_model_phase]. */
+    pickplaz_model_t model[2][APP_MODEL_PHASES];
+    /** Models whose next timed move runs on the fixed timeout, same indexing. */
+    bool model_probe[2][APP_MODEL_PHASES];
+    pickplaz_model_config_t model_config;
+    /** Calibration moves still to queue, indexed by [forward]. */
+    uint16_t calib_left[2];
+    /** Increments ended by a timeout. */
+    uint32_t model_timeouts;
+    pickplaz_fsm_stats_t fsm_stats[APP_STATE_COUNT];
+    pickplaz_app_feeder_stats_t stats;
+    pickplaz_feeder_map_t map;
+} pickplaz_feeder_t;
+
+/**
+ * @brief Feeder instances, processed in index order every step.
+ *
+ * @details
+ * Only the map is set before pickplaz_app_init(); the default is the
+ * board's single feeder, replaced by pickplaz_app_configure().
+ */
+static pickplaz_feeder_t app_feeders[PICKPLAZ_APP_FEEDERS_MAX] = {
+    [0].map = {
+        .led_pins = { BOARD_GPIO_LED0, BOARD_GPIO_LED1, BOARD_GPIO_LED2, BOARD_GPIO_LED3 },
+        .led_channels = { APP_PWM_LED0_CH, APP_PWM_LED1_CH, APP_PWM_LED2_CH, APP_PWM_LED3_CH },
+        .feed_led_pin = BOARD_GPIO_LED4,
+        .motor_in1_pin = BOARD_GPIO_MOTOR_IN1,
+        .motor_in2_pin = BOARD_GPIO_MOTOR_IN2,
+        .motor_in1_channel = APP_PWM_MOTOR_IN1_CH,
+        .motor_in2_channel = APP_PWM_MOTOR_IN2_CH,
+        .button_forward_pin = BOARD_GPIO_BUTTON_FWD,
+        .button_backward_pin = BOARD_GPIO_BUTTON_REV,
+        .button_active_low = BOARD_BUTTON_ACTIVE_LOW,
+        .feed_pin = HAL_FEED_PIN,
+        .opto_pin = BOARD_GPIO_OPTO_INT,
+        .opto_adc_channel = HAL_OPTO_ADC_CHANNEL,
+    },
 };
+static size_t app_feeder_count = 1;
+
+/**
+ * @brief Looks up a configured feeder by index.
+ *
+ * @param index Feeder index.
+ * @return The feeder, or NULL when index is out of range.
+ */
+static pickplaz_feeder_t *app_feeder(size_t index) {
+    return index < app_feeder_count ? &app_feeders[index] : NULL;
+}
+
+/** GPIO inputs configured at init; sampled together once per control step. */
+static hal_gpio_mask_t app_input_mask;
+/** Active-low inputs, XORed into each sample so a set bit always means active. */
+static hal_gpio_mask_t app_input_invert;
+/** Normalized input snapshot for the current control step. */
+static hal_gpio_mask_t app_inputs;
 
+/** PWM duties requested by the logic steps of the current tick, all feeders. */
+static hal_pwm_frame_t app_pwm_frame;
+
+/** True when LED animations run on the LEDC fade engine instead of the frame. */
+static bool app_led_fade;
+
+/** Digital outputs owned by the app, committed together by app_outputs_commit(). */
+static hal_gpio_mask_t app_output_mask;
+/** Output frame: levels requested by the logic steps of the current tick. */
+static hal_gpio_mask_t app_output_frame;
+/** Levels last written to the hardware. */
+static hal_gpio_mask_t app_output_shadow;
+
+/** Logical milliseconds: one per executed logic step, not per callback. */
 static uint32_t app_tick_ms;
-static uint32_t opto_is_indexed;
-
-static feed_fsm_t feed_state;
-static feed_signal_t feed_signal_state;
-static uint32_t feed_timer;
-static uint32_t feed_led_counter;
-
-static uint32_t app_forward_request;
-static uint32_t app_backward_request;
-static uint32_t app_forward_continuous_rq;
-static uint32_t app_backward_continuous_rq;
-static app_state_t app_state = APP_init;
-static uint32_t app_timer;
-
-static int32_t motor_target;
-static motor_state_t motor_state = MOTOR_init;
-static uint32_t motor_timer;
-static uint32_t motor_brake_pwm;
-static bool motor_brake_forward;
-static uint32_t motor_last_pwm;
-static bool motor_last_forward;
+/** Scheduled time of the logic step being executed. */
+static int64_t app_step_us;
+static int64_t app_next_step_us;
+static bool app_time_synced;
+static pickplaz_app_timing_t app_timing;
+
+/** Suspend the tick whenever app_quiescent() holds. */
+static bool app_event_driven;
+/** The tick is suspended; the next advance skips the idle time. */
+static bool app_suspended;
+/** app_quiescent() as left by the last advance. */
+static bool app_idle;
+/** After a wake, steps keep running until app_tick_ms reaches this. */
+static uint32_t app_wake_until_ms;
+static bool app_wake_timer_armed;
+/** Host commands; the producer is the single host command task. */
+static pickplaz_event_ring_t app_events_host;
+/** Timer expiries; the producer is the HAL timer task. */
+static pickplaz_event_ring_t app_events_timer;
+static pickplaz_app_load_t app_load;
+static int64_t app_load_last_us;
+static bool app_load_started;
 
 static uint32_t sine_speed = 55;
 
@@ -244,663 +528,3205 @@ static void app_set_led_duty(int channel, uint32_t stm32_value) {
     if (stm32_value > APP_PWM_STM32_MAX) {
         stm32_value = APP_PWM_STM32_MAX;
     }
-    hal_pwm_set_duty(channel, app_pwm_scale(stm32_value));
+    app_pwm_frame.duty[channel] = app_pwm_scale(stm32_value);
 }
 
-static bool app_gpio_is_active(int pin, bool active_low) {
-    if (!app_pin_valid(pin)) {
-        return false;
+/**
+ * @brief Captures all configured inputs in one coherent sample.
+ *
+ * @details
+ * One GPIO_IN register read covers buttons, feed, and opto; polarity is
+ * normalized with the precomputed XOR mask so consumers only test bits.
+ *
+ * Postconditions:
+ * - app_inputs holds the active state of every configured input.
+ */
+static void app_inputs_sample(void) {
+    app_inputs = hal_gpio_read_mask(app_input_mask) ^ app_input_invert;
+}
+
+static bool app_input_active(hal_gpio_mask_t bit) {
+    return (app_inputs & bit) != 0;
+}
+
+static void app_output_set(hal_gpio_mask_t bit, bool high) {
+    if (high) {
+        app_output_frame |= bit;
+    } else {
+        app_output_frame &= ~bit;
     }
-    hal_gpio_level_t level = hal_gpio_read(pin);
-    return active_low ? (level == HAL_GPIO_LOW) : (level == HAL_GPIO_HIGH);
 }
 
 /**
- * @brief Samples and debounces a button, returning edge events.
+ * @brief Applies the output frame to the GPIOs in one set/clear pair.
  *
  * @details
- * Implements the STM32 timing model: a debounce counter followed by press
- * timing. Returns BUTTON_short/BUTTON_long on release and BUTTON_hold while
- * the button remains held.
- *
- * Preconditions:
- * - button must be non-null and initialized with pin and polarity.
+ * Logic steps only edit app_output_frame; this commit diffs it against the
+ * shadow of the last written levels and pushes only changed pins, so a tick
+ * with no output change performs no register write and pins that change
+ * together switch together.
  *
  * Postconditions:
- * - Debounce and press counters are updated.
+ * - app_output_shadow matches the frame for all owned outputs.
  *
  * Side effects:
- * - Reads GPIO through the HAL.
- *
- * @param button Button state storage. Must not be NULL.
- * @return Button event for this tick.
+ * - Writes GPIO output registers through the HAL when levels changed.
  */
-static button_event_t app_button_update(app_button_t *button) {
-    bool pressed = app_gpio_is_active(button->pin, button->active_low);
-
-    if (pressed) {
-        if (button->cnt < APP_BUTTON_CNT_MAX) {
-            button->cnt++;
-        }
-    } else if (button->cnt > 0) {
-        button->cnt--;
+static void app_outputs_commit(void) {
+    hal_gpio_mask_t changed = (app_output_frame ^ app_output_shadow) & app_output_mask;
+    if (changed == 0) {
+        return;
     }
+    if (hal_gpio_write_mask(changed & app_output_frame,
+                            changed & ~app_output_frame) == HAL_OK) {
+        app_output_shadow ^= changed;
+    }
+}
 
-    bool debounced = button->cnt > (APP_BUTTON_CNT_MAX / 2);
-    if (debounced) {
-        button->press++;
-        if (button->press > APP_BUTTON_LONGPRESS) {
-            return BUTTON_hold;
+/**
+ * @brief Pushes the PWM frame to the HAL.
+ *
+ * @details
+ * The HAL diffs the frame against its duty shadow, so channels the logic
+ * re-requested with an unchanged value (idle motor, static LEDs) cost no
+ * LEDC driver call. Each feeder's motor inputs go first, as one paired
+ * update that latches IN1 and IN2 on the same PWM period, so reversals and
+ * brake entries never run a period with one input stale.
+ *
+ * Side effects:
+ * - Updates LEDC duty for channels whose value changed.
+ */
+static void app_pwm_commit(void) {
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        const pickplaz_feeder_t *feeder = &app_feeders[i];
+        if (feeder->motor_paired) {
+            int in1 = feeder->map.motor_in1_channel;
+            int in2 = feeder->map.motor_in2_channel;
+            hal_pwm_set_duty_pair(in1, app_pwm_frame.duty[in1], in2, app_pwm_frame.duty[in2]);
         }
-        return BUTTON_none;
     }
+    hal_pwm_commit(&app_pwm_frame);
+}
 
-    if (button->press) {
-        button_event_t ev = BUTTON_none;
-        if (button->press > APP_BUTTON_LONGPRESS) {
-            ev = BUTTON_long;
-        } else {
-            ev = BUTTON_short;
+/**
+ * @brief Feeds a button's new edges to its debouncer and polls it.
+ *
+ * @details
+ * Edges come from the HAL edge ring with ISR timestamps, or from snapshot
+ * level changes stamped with the step time when capture is unavailable.
+ * Returns PICKPLAZ_BUTTON_SHORT/LONG on release and PICKPLAZ_BUTTON_HOLD
+ * while the button remains held past the long-press threshold. An idle
+ * button costs one empty ring check and no debouncer work.
+ *
+ * Preconditions:
+ * - button must be non-null and initialized by app_configure_buttons().
+ * - app_inputs_sample() has captured this step's inputs.
+ *
+ * @param button Button state storage. Must not be NULL.
+ * @return Button event for this step.
+ */
+static pickplaz_button_event_t app_button_update(app_button_t *button) {
+    if (button->edges) {
+        hal_gpio_edge_event_t event;
+        while (hal_gpio_edge_pop(button->pin, &event)) {
+            pickplaz_button_edge(&button->engine,
+                                 (event.level == HAL_GPIO_HIGH) != button->active_low,
+                                 event.time_us);
+        }
+    } else {
+        bool active = app_input_active(button->bit);
+        if (active != button->engine.raw) {
+            pickplaz_button_edge(&button->engine, active, app_step_us);
         }
-        button->press = 0;
-        return ev;
     }
-    return BUTTON_none;
+    if (!pickplaz_button_busy(&button->engine)) {
+        return PICKPLAZ_BUTTON_NONE;
+    }
+    return pickplaz_button_poll(&button->engine, app_step_us);
 }
 
 /**
  * @brief Drives the motor H-bridge outputs with scaled PWM.
  *
  * @details
- * Applies the STM32-style duty value (0..2048) to the ESP32 LEDC channels.
- * Forward drives IN2, backward drives IN1, matching the STM32 polarity model.
+ * Applies the STM32-style duty value (0..2048) to the motor channels of the
+ * PWM frame. Forward drives IN2, backward drives IN1, matching the STM32
+ * polarity model. In fast decay the other input is held low, as on the
+ * STM32; in slow decay the driven input is held high and the other carries
+ * the inverted duty, so the bridge brakes rather than coasts between
+ * pulses and speed follows duty more linearly at low duty. A short brake
+ * drives both inputs at the duty, fully high at 2048. Both inputs are
+ * always written together so the paired commit sees a consistent bridge
+ * state.
  *
  * Preconditions:
  * - Motor PWM channels are initialized via hal_pwm_init().
  *
  * Side effects:
- * - Updates LEDC duty on the motor output channels.
+ * - Updates the PWM frame; hardware changes at app_pwm_commit().
  *
+ * @param feeder Feeder whose motor channels are written.
  * @param pwm Duty value in STM32 units (0..2048).
  * @param forward True for forward direction, false for reverse.
+ * @param drive Decay mode or short brake.
  */
-static void app_set_motor(uint32_t pwm, bool forward) {
+static void app_set_motor(pickplaz_feeder_t *feeder, uint32_t pwm, bool forward,
+                          motor_drive_t drive) {
     uint32_t duty = app_pwm_scale(pwm);
-    if (forward) {
-        hal_pwm_set_duty(APP_PWM_MOTOR_IN1_CH, 0);
-        hal_pwm_set_duty(APP_PWM_MOTOR_IN2_CH, duty);
-    } else {
-        hal_pwm_set_duty(APP_PWM_MOTOR_IN1_CH, duty);
-        hal_pwm_set_duty(APP_PWM_MOTOR_IN2_CH, 0);
+    uint32_t driven = duty;
+    uint32_t other = 0U;
+    if (drive == MOTOR_DRIVE_SLOW_DECAY) {
+        driven = app_pwm_max();
+        other = driven - duty;
+    } else if (drive == MOTOR_DRIVE_SHORT_BRAKE) {
+        other = duty;
     }
+    app_pwm_frame.duty[feeder->map.motor_in1_channel] = forward ? other : driven;
+    app_pwm_frame.duty[feeder->map.motor_in2_channel] = forward ? driven : other;
+}
+
+/**
+ * @brief Queues a feed command and flashes the feed indicator.
+ *
+ * @param feeder Feeder the command is for.
+ * @param forward Feed direction.
+ * @param pockets Pockets to feed; counts beyond 16 bits are clamped.
+ */
+static void app_queue_feed(pickplaz_feeder_t *feeder, bool forward, uint32_t pockets) {
+    uint16_t count = pockets > UINT16_MAX ? UINT16_MAX : (uint16_t)pockets;
+    pickplaz_queue_push(&feeder->requests, forward, count, app_step_us);
+    feeder->feed_led_trigger = true;
 }
 
 /**
- * @brief Updates the feed pulse FSM.
+ * @brief Feeds feed-pin edges to the pulse decoder and queues commands.
  *
  * @details
- * Detects short/long feed pulses on HAL_FEED_PIN using the 1 kHz tick and
- * updates feed_signal_state accordingly. If the feed pin is not configured,
- * the FSM remains idle.
+ * Edges come from the HAL edge ring with ISR timestamps, or from snapshot
+ * level changes stamped with the step time when capture is unavailable.
+ * Pulse widths are measured in microseconds against HAL_FEED_* thresholds;
+ * a decoded burst of short (forward) or long (backward) pulses is queued
+ * with its pocket count behind any requests still waiting. If the feed pin
+ * is not configured, the decoder remains idle.
  *
  * Preconditions:
- * - HAL_FEED_PIN is configured as input when enabled.
+ * - The feed pin is configured as input when enabled.
+ * - app_inputs_sample() has captured this step's inputs.
  *
  * Postconditions:
- * - feed_signal_state reflects the most recent pulse classification.
+ * - A completed burst is in the request queue, or counted as dropped.
  *
- * Side effects:
- * - Reads GPIO through the HAL.
+ * @param feeder Feeder whose feed pin is decoded.
  */
-static void run_feed_fsm(void) {
-    if (!app_pin_valid(HAL_FEED_PIN)) {
+static void run_feed_fsm(pickplaz_feeder_t *feeder) {
+    int pin = feeder->map.feed_pin;
+    if (!app_pin_valid(pin)) {
         return;
     }
 
-    bool feed_pin_state = app_gpio_is_active(HAL_FEED_PIN, HAL_FEED_ACTIVE_LOW);
-    switch (feed_state) {
-    case FEED_fsm_low:
-        if (feed_pin_state) {
-            feed_timer = 0;
-            feed_state = FEED_fsm_high;
-        }
-        break;
-    case FEED_fsm_high:
-    default:
-        if (!feed_pin_state) {
-            if (feed_timer > 10) {
-                feed_signal_state = FEED_long;
-            } else {
-                feed_signal_state = FEED_short;
-            }
-            feed_state = FEED_fsm_low;
+    if (feeder->feed_edges) {
+        hal_gpio_edge_event_t event;
+        while (hal_gpio_edge_pop(pin, &event)) {
+            pickplaz_feed_edge(&feeder->feed_decoder,
+                               (event.level == HAL_GPIO_HIGH) != (HAL_FEED_ACTIVE_LOW != 0),
+                               event.time_us);
         }
-        feed_timer++;
-        break;
+    } else {
+        pickplaz_feed_edge(&feeder->feed_decoder, app_input_active(HAL_GPIO_BIT(pin)),
+                           app_step_us);
+    }
+
+    pickplaz_feed_cmd_t cmd;
+    if (pickplaz_feed_busy(&feeder->feed_decoder) &&
+        pickplaz_feed_poll(&feeder->feed_decoder, app_step_us, &cmd)) {
+        app_queue_feed(feeder, cmd.forward, cmd.pockets);
     }
 }
 
 /**
- * @brief Advances the main application FSM.
+ * @brief Reports whether the oldest queued request feeds in one direction.
  *
- * @details
- * Updates application state transitions, timers, and motor_target based on
- * button requests, feed signals, and opto indexing status.
+ * @param feeder Feeder to check.
+ * @param forward Direction to match.
+ * @return True when a request is queued and its direction matches.
+ */
+static bool app_request_pending(const pickplaz_feeder_t *feeder, bool forward) {
+    const pickplaz_queue_req_t *head = pickplaz_queue_peek(&feeder->requests);
+    return head != NULL && head->forward == forward;
+}
+
+/**
+ * @brief Takes the oldest queued request if it feeds in one direction.
  *
- * Preconditions:
- * - app_state and request flags are initialized.
+ * @details
+ * The request is taken whole, so its pockets, coalesced ones included, run
+ * as one chained move. Its wait in the queue is recorded as the queueing
+ * latency.
  *
- * Postconditions:
- * - app_state, app_timer, and motor_target are updated.
+ * @param feeder Feeder whose request is taken.
+ * @param forward Direction to match.
+ * @return Pockets taken, or 0 when the oldest request does not match.
  */
-static void run_app_fsm(void) {
-    switch (app_state) {
-    case APP_init:
-        app_state = APP_idle;
-        app_timer = 200;
-        break;
-    case APP_idle:
-        motor_target = MOTOR_STOP;
-        if (app_forward_request || feed_signal_state == FEED_short) {
-            app_state = APP_increment_forward1;
-            app_forward_request = 0;
-            app_timer = 500;
-            if (feed_signal_state == FEED_short) {
-                feed_signal_state = FEED_none;
-            }
-        }
-        if (app_backward_request || feed_signal_state == FEED_long) {
-            app_state = APP_increment_backward1;
-            app_backward_request = 0;
-            app_timer = 500;
-            if (feed_signal_state == FEED_long) {
-                feed_signal_state = FEED_none;
-            }
-        }
-        if (app_forward_continuous_rq) {
-            app_state = APP_free_forward;
-        }
-        if (app_backward_continuous_rq) {
-            app_state = APP_free_backward;
-        }
-        break;
-    case APP_increment_forward1:
-        motor_target = MOTOR_FORWARD_NORMAL;
-        if (!opto_is_indexed) {
-            app_state = APP_increment_forward2;
-            app_timer = 1500;
-        }
-        if (app_timer) {
-            app_timer--;
-        } else {
-            app_state = APP_idle;
-        }
-        break;
-    case APP_increment_forward2:
-        motor_target = MOTOR_FORWARD_NORMAL;
-        if (opto_is_indexed) {
-            app_state = APP_idle;
-        }
-        if (app_timer) {
-            app_timer--;
-        } else {
-            app_state = APP_idle;
-        }
-        break;
-    case APP_increment_backward1:
-        motor_target = MOTOR_BACKWARD_NORMAL;
-        if (!opto_is_indexed) {
-            app_state = APP_increment_backward2;
-            app_timer = 1500;
-        }
-        if (app_timer) {
-            app_timer--;
-        } else {
-            app_state = APP_idle;
-        }
-        break;
-    case APP_increment_backward2:
-        motor_target = MOTOR_BACKWARD_NORMAL;
-        if (opto_is_indexed) {
-            app_state = APP_idle;
-        }
-        if (app_timer) {
-            app_timer--;
-        } else {
-            app_state = APP_idle;
-        }
-        break;
-    case APP_free_forward:
-        motor_target = MOTOR_FORWARD_FAST;
-        if (!app_forward_continuous_rq) {
-            app_state = APP_increment_forward2;
-            app_timer = 1500;
-        }
-        break;
-    case APP_free_backward:
-        motor_target = MOTOR_BACKWARD_FAST;
-        if (!app_backward_continuous_rq) {
-            app_state = APP_increment_backward2;
-            app_timer = 1500;
-        }
-        break;
-    default:
-        app_state = APP_init;
-        break;
+static uint32_t app_take_pockets(pickplaz_feeder_t *feeder, bool forward) {
+    pickplaz_queue_req_t req;
+    if (!app_request_pending(feeder, forward) || !pickplaz_queue_pop(&feeder->requests, &req)) {
+        return 0;
+    }
+    uint32_t latency = (uint32_t)(app_step_us - req.time_us);
+    feeder->queue_latency_last_us = latency;
+    if (latency > feeder->queue_latency_max_us) {
+        feeder->queue_latency_max_us = latency;
     }
+    return req.pockets;
 }
 
 /**
- * @brief Advances the motor control FSM.
+ * @brief Takes the request that starts a move from idle.
  *
  * @details
- * Translates motor_target into PWM outputs, applies active braking when
- * stopping, and tracks the last commanded direction for brake polarity.
- *
- * Preconditions:
- * - motor_target is updated by run_app_fsm().
+ * Requests run in arrival order, one queued request per move. A held
+ * button wins over the queue and discards it, so a manual jog never
+ * resumes a stale feed job. Only a move that starts on an index has its
+ * timing sampled; from anywhere else it leaves at once and travels a
+ * partial pocket.
  *
- * Postconditions:
- * - PWM outputs reflect the desired motor behavior.
+ * @param ctx Feeder.
  */
-static void run_motor_fsm(void) {
-    switch (motor_state) {
-    case MOTOR_init:
-        app_set_motor(0, true);
-        motor_state = MOTOR_idle;
-        break;
-    case MOTOR_idle:
-        app_set_motor(0, true);
-        if (motor_target > 0) {
-            motor_state = MOTOR_running_forward;
-        } else if (motor_target < 0) {
-            motor_state = MOTOR_running_backward;
-        }
-        break;
-    case MOTOR_running_forward:
-        if (motor_target == 0) {
-            motor_state = MOTOR_brake;
-            motor_timer = 8;
-            motor_brake_pwm = motor_last_pwm;
-            motor_brake_forward = !motor_last_forward;
-            app_set_motor(motor_brake_pwm, motor_brake_forward);
-        } else {
-            motor_last_pwm = (uint32_t)motor_target;
-            motor_last_forward = true;
-            app_set_motor((uint32_t)motor_target, true);
-        }
-        break;
-    case MOTOR_running_backward:
-        if (motor_target == 0) {
-            motor_state = MOTOR_brake;
-            motor_timer = 8;
-            motor_brake_pwm = motor_last_pwm;
-            motor_brake_forward = !motor_last_forward;
-            app_set_motor(motor_brake_pwm, motor_brake_forward);
-        } else {
-            motor_last_pwm = (uint32_t)(-motor_target);
-            motor_last_forward = false;
-            app_set_motor((uint32_t)(-motor_target), false);
-        }
-        break;
-    case MOTOR_brake:
-        if (motor_timer) {
-            motor_timer--;
-        } else {
-            motor_state = MOTOR_idle;
-        }
-        if (motor_target != 0) {
-            motor_state = MOTOR_idle;
-        }
-        break;
-    default:
-        motor_state = MOTOR_init;
-        break;
+static void app_idle_take_requests(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    if (feeder->forward_continuous_rq || feeder->backward_continuous_rq) {
+        pickplaz_queue_flush(&feeder->requests);
+        feeder->move_pockets = 1;
+        return;
     }
+    const pickplaz_queue_req_t *head = pickplaz_queue_peek(&feeder->requests);
+    feeder->move_pockets = head != NULL ? app_take_pockets(feeder, head->forward) : 0;
+    feeder->move_from_rest = feeder->opto_is_indexed != 0U;
+}
+
+static bool app_guard_forward_hold(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->forward_continuous_rq != 0;
+}
+
+static bool app_guard_backward_hold(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->backward_continuous_rq != 0;
+}
+
+static bool app_guard_forward_released(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->forward_continuous_rq == 0;
+}
+
+static bool app_guard_backward_released(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->backward_continuous_rq == 0;
+}
+
+static bool app_guard_forward_request(void *ctx) {
+    return app_request_pending(ctx, true);
+}
+
+static bool app_guard_backward_request(void *ctx) {
+    return app_request_pending(ctx, false);
+}
+
+static bool app_guard_indexed(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->opto_is_indexed != 0U;
+}
+
+static bool app_guard_left_index(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->opto_is_indexed == 0U;
 }
 
 /**
- * @brief Computes LED animation PWM values for the current state.
+ * @brief Reports whether the running increment stops on the next index.
  *
  * @details
- * Reproduces STM32 LED patterns: idle/indexed, idle/unindexed, forward and
- * backward motion waves, and the default sine animation.
+ * A queued request in the direction of travel extends the move, so a
+ * button pressed again or a new feed command is chained instead of waiting
+ * for the stop. A request the other way waits for the stop.
  *
- * Side effects:
- * - Updates LED PWM channels via the HAL when LEDs are enabled.
+ * @param feeder Feeder to check.
+ * @return True when no pocket follows the current one.
  */
-static void eval_led_pwm(void) {
-    uint32_t led0 = 0;
-    uint32_t led1 = 0;
-    uint32_t led2 = 0;
-    uint32_t led3 = 0;
+static bool app_increment_final(const pickplaz_feeder_t *feeder) {
+    app_state_t state = (app_state_t)feeder->fsm.state;
+    bool forward = state == APP_increment_forward1 || state == APP_increment_forward2;
+    return feeder->move_pockets <= 1U && !app_request_pending(feeder, forward);
+}
 
-    if (app_state == APP_idle) {
-        if (opto_is_indexed) {
-            led3 = APP_PWM_STM32_MAX;
-        } else {
-            uint32_t t1 = app_tick_ms;
-            uint32_t t2 = t1 + 128;
-            led1 = sintab[t1 % APP_SINE_LEN] * APP_SINE_SCALE;
-            led2 = sintab[t2 % APP_SINE_LEN] * APP_SINE_SCALE;
-        }
-    } else if (app_state == APP_increment_forward1 ||
-               app_state == APP_increment_forward2 ||
-               app_state == APP_free_forward) {
-        uint32_t t1 = app_tick_ms;
-        uint32_t t2 = t1 + sine_speed;
-        uint32_t t3 = t2 + sine_speed;
-        uint32_t t4 = t3 + sine_speed;
-        led0 = sintab[t1 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led1 = sintab[t2 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led2 = sintab[t3 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led3 = sintab[t4 % APP_SINE_LEN] * APP_SINE_SCALE;
-    } else if (app_state == APP_increment_backward1 ||
-               app_state == APP_increment_backward2 ||
-               app_state == APP_free_backward) {
-        uint32_t t4 = app_tick_ms;
-        uint32_t t3 = t4 + sine_speed;
-        uint32_t t2 = t3 + sine_speed;
-        uint32_t t1 = t2 + sine_speed;
-        led0 = sintab[t1 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led1 = sintab[t2 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led2 = sintab[t3 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led3 = sintab[t4 % APP_SINE_LEN] * APP_SINE_SCALE;
-    } else {
-        uint32_t t1 = app_tick_ms;
-        uint32_t t2 = t1 + 128;
-        uint32_t t3 = t2 + 128;
-        uint32_t t4 = t3 + 128;
-        led0 = sintab[t1 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led1 = sintab[t2 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led2 = sintab[t3 % APP_SINE_LEN] * APP_SINE_SCALE;
-        led3 = sintab[t4 % APP_SINE_LEN] * APP_SINE_SCALE;
-    }
+static bool app_guard_indexed_chained(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    return feeder->opto_is_indexed != 0U && !app_increment_final(feeder);
+}
 
-    if (app_pin_valid(BOARD_GPIO_LED0)) {
-        app_set_led_duty(APP_PWM_LED0_CH, led0);
-    }
-    if (app_pin_valid(BOARD_GPIO_LED1)) {
-        app_set_led_duty(APP_PWM_LED1_CH, led1);
-    }
-    if (app_pin_valid(BOARD_GPIO_LED2)) {
-        app_set_led_duty(APP_PWM_LED2_CH, led2);
-    }
-    if (app_pin_valid(BOARD_GPIO_LED3)) {
-        app_set_led_duty(APP_PWM_LED3_CH, led3);
-    }
+/**
+ * @brief Returns the learned model of one half of an increment.
+ *
+ * @param feeder Feeder whose model is returned.
+ * @param forward Direction of the increment.
+ * @param phase Half of the increment.
+ * @return Model state.
+ */
+static pickplaz_model_t *app_model(pickplaz_feeder_t *feeder, bool forward,
+                                   app_model_phase_t phase) {
+    return &feeder->model[forward ? 1 : 0][phase];
 }
 
 /**
- * @brief Drives the feed indicator LED.
+ * @brief Adds the duration of the current state to a model.
  *
  * @details
- * Emits a 500 ms pulse when a feed event is detected. Uses LED4 when
- * available; otherwise falls back to LED3 to preserve visibility.
+ * Only single moves from idle are sampled, so every sample describes the
+ * same start from rest and stop on the index. Calibration samples are
+ * exact; production moves update the moving average. A sample ends the
+ * probe started by a learned timeout.
  *
- * Side effects:
- * - Updates LED4 GPIO or LED3 PWM output.
+ * @param feeder Feeder whose model is updated.
+ * @param forward Direction of the increment.
+ * @param phase Half of the increment that just ended.
  */
-static void eval_led_feed(void) {
-    if (feed_signal_state != FEED_none) {
-        feed_led_counter = APP_FEED_PULSE_MS;
-    }
-    if (feed_led_counter) {
-        feed_led_counter--;
-    }
-    if (app_pin_valid(BOARD_GPIO_LED4)) {
-        hal_gpio_write(BOARD_GPIO_LED4,
-                       feed_led_counter ? HAL_GPIO_HIGH : HAL_GPIO_LOW);
+static void app_model_sample(pickplaz_feeder_t *feeder, bool forward, app_model_phase_t phase) {
+    if (!feeder->move_from_rest) {
         return;
     }
-    if (feed_led_counter) {
-        app_set_led_duty(APP_PWM_LED3_CH, APP_PWM_STM32_MAX);
-    }
+    pickplaz_model_sample(app_model(feeder, forward, phase), &feeder->model_config,
+                          feeder->fsm.dwell, feeder->calibrating);
+    feeder->model_probe[forward ? 1 : 0][phase] = false;
 }
 
 /**
- * @brief Updates opto indexing status from ADC or GPIO.
+ * @brief Returns the timeout of one half of an increment.
  *
  * @details
- * If HAL_OPTO_ADC_CHANNEL is configured, uses hysteresis thresholds to avoid
- * flapping. Otherwise reads BOARD_GPIO_OPTO_INT with configurable polarity.
- *
- * Postconditions:
- * - opto_is_indexed reflects the latest sampled input.
+ * While a probe is pending the fixed timeout applies, so a feeder that has
+ * slowed beyond the learned timeout can still complete a move and feed the
+ * longer duration back into the model.
  *
- * Side effects:
- * - Reads ADC or GPIO through the HAL.
+ * @param feeder Feeder whose model is used.
+ * @param forward Direction of the increment.
+ * @param phase Half of the increment.
+ * @param fallback Fixed timeout, in steps.
+ * @return Timeout in steps.
  */
-static void app_update_opto(void) {
-    if (app_pin_valid(HAL_OPTO_ADC_CHANNEL)) {
-        int adc_value = hal_adc_read(HAL_OPTO_ADC_CHANNEL);
-        if (adc_value >= 0) {
-            if (opto_is_indexed) {
-                opto_is_indexed = (uint32_t)adc_value > HAL_OPTO_ADC_LOW_THRESHOLD;
-            } else {
-                opto_is_indexed = (uint32_t)adc_value > HAL_OPTO_ADC_HIGH_THRESHOLD;
-            }
+static uint32_t app_model_timeout(pickplaz_feeder_t *feeder, bool forward,
+                                  app_model_phase_t phase, uint32_t fallback) {
+    if (feeder->model_probe[forward ? 1 : 0][phase]) {
+        return fallback;
+    }
+    return pickplaz_model_timeout(app_model(feeder, forward, phase), &feeder->model_config,
+                                  fallback);
+}
+
+/**
+ * @brief Discards the learned timing of both directions.
+ *
+ * @param feeder Feeder whose models are reset.
+ */
+static void app_model_reset(pickplaz_feeder_t *feeder) {
+    for (size_t dir = 0; dir < 2; dir++) {
+        for (size_t phase = 0; phase < APP_MODEL_PHASES; phase++) {
+            pickplaz_model_reset(&feeder->model[dir][phase]);
+            feeder->model_probe[dir][phase] = false;
         }
-        return;
     }
+}
+
+/**
+ * @brief Shortens the first-half timeout to the learned leave time.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_enter_leave(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    bool forward = feeder->fsm.state == APP_increment_forward1;
+    feeder->fsm.timer =
+        (uint16_t)app_model_timeout(feeder, forward, APP_MODEL_LEAVE, feeder->fsm.timer);
+}
+
+/**
+ * @brief Shortens the second-half timeout to the learned travel time.
+ *
+ * @details
+ * Only moves that left an index are timed; the second half of a
+ * continuous move starts anywhere in the pocket and keeps the fixed
+ * timeout.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_enter_travel(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    bool forward = feeder->fsm.state == APP_increment_forward2;
+    if (feeder->motor_move_learn) {
+        feeder->fsm.timer =
+            (uint16_t)app_model_timeout(feeder, forward, APP_MODEL_TRAVEL, feeder->fsm.timer);
+    }
+}
+
+static void app_dwell_stop(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_STOP;
+}
+
+static void app_dwell_forward(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_FORWARD_NORMAL;
+}
+
+static void app_dwell_backward(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_BACKWARD_NORMAL;
+}
+
+static void app_dwell_forward_fast(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_FORWARD_FAST;
+}
+
+static void app_dwell_backward_fast(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_BACKWARD_FAST;
+}
+
+/**
+ * @brief Starts the second half of an increment from the previous index.
+ *
+ * @details
+ * The move starts at an index, so its length describes a full pocket and
+ * may be learned by the motion profile. Only the final pocket of a chained
+ * move gets an approach phase. Once the travel model is ready it places
+ * the approach of the time predictor instead of the last move alone.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_begin_indexed(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    bool forward = feeder->fsm.state == APP_increment_forward1;
+    app_model_sample(feeder, forward, APP_MODEL_LEAVE);
+    const pickplaz_model_t *travel = app_model(feeder, forward, APP_MODEL_TRAVEL);
+    if (feeder->motor_profile.config.predictor == PICKPLAZ_PROFILE_PREDICT_TIME &&
+        pickplaz_model_ready(travel, &feeder->model_config)) {
+        pickplaz_profile_expect(&feeder->motor_profile, pickplaz_model_mean(travel));
+    }
+    pickplaz_profile_move_begin(&feeder->motor_profile, app_increment_final(feeder));
+    feeder->motor_move_learn = true;
+}
+
+/**
+ * @brief Starts the second half of an increment after a continuous move.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_begin_free(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->move_pockets = 1;
+    feeder->move_from_rest = false;
+    pickplaz_profile_move_begin(&feeder->motor_profile, true);
+    feeder->motor_move_learn = false;
+}
+
+/**
+ * @brief Ends an increment on the index.
+ *
+ * @details
+ * Stops in this step so an ISR cut is not re-driven before braking.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_reached(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    feeder->motor_target = MOTOR_STOP;
+    if (feeder->motor_move_learn) {
+        app_model_sample(feeder, feeder->fsm.state == APP_increment_forward2, APP_MODEL_TRAVEL);
+    }
+    pickplaz_profile_move_end(&feeder->motor_profile, feeder->motor_move_learn);
+}
+
+/**
+ * @brief Counts a pocket passed on the index and keeps the motor running.
+ *
+ * @details
+ * The pocket just completed is learned like a stopped one. Requests that
+ * extended the move are taken here.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_pass(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    bool forward = feeder->fsm.state == APP_increment_forward2;
+    pickplaz_profile_move_end(&feeder->motor_profile, feeder->motor_move_learn);
+    feeder->move_pockets += app_take_pockets(feeder, forward);
+    feeder->move_pockets--;
+    feeder->move_from_rest = false;
+}
 
-    if (app_pin_valid(BOARD_GPIO_OPTO_INT)) {
-        bool active = app_gpio_is_active(BOARD_GPIO_OPTO_INT, !HAL_OPTO_ACTIVE_HIGH);
-        opto_is_indexed = active ? 1U : 0U;
+/**
+ * @brief Ends an increment that timed out before leaving or reaching an index.
+ *
+ * @details
+ * With a learned model the timeout is the jam detector, so every one is
+ * counted. A timed-out move is never sampled, so a feeder that slowed past
+ * the learned timeout would otherwise time out on every move; the next
+ * sampled move of that half instead runs on the fixed timeout as a probe.
+ *
+ * @param ctx Feeder.
+ */
+static void app_increment_timeout(void *ctx) {
+    pickplaz_feeder_t *feeder = ctx;
+    uint8_t state = feeder->fsm.state;
+    bool forward = state == APP_increment_forward1 || state == APP_increment_forward2;
+    bool leave = state == APP_increment_forward1 || state == APP_increment_backward1;
+    app_model_phase_t phase = leave ? APP_MODEL_LEAVE : APP_MODEL_TRAVEL;
+    feeder->model_timeouts++;
+    if (pickplaz_model_ready(app_model(feeder, forward, phase), &feeder->model_config)) {
+        feeder->model_probe[forward ? 1 : 0][phase] = true;
     }
+    pickplaz_profile_move_end(&feeder->motor_profile, false);
 }
 
 /**
- * @brief Executes one 1 kHz application tick.
+ * @brief Application FSM timeouts, in control steps.
+ */
+enum app_fsm_timeouts {
+    APP_FSM_LEAVE_INDEX_STEPS = 500,
+    APP_FSM_NEXT_INDEX_STEPS = 1500,
+    /* The first half has already counted its final step against the second. */
+    APP_FSM_NEXT_INDEX_AFTER_LEAVE_STEPS = APP_FSM_NEXT_INDEX_STEPS - 1,
+};
+
+static const pickplaz_fsm_transition_t app_init_out[] = {
+    { .target = APP_idle },
+};
+
+/* Later checks won in the original if-chain, so they come first here. */
+static const pickplaz_fsm_transition_t app_idle_out[] = {
+    { app_guard_backward_hold, app_idle_take_requests, APP_free_backward, 0 },
+    { app_guard_forward_hold, app_idle_take_requests, APP_free_forward, 0 },
+    { app_guard_backward_request, app_idle_take_requests, APP_increment_backward1, 0 },
+    { app_guard_forward_request, app_idle_take_requests, APP_increment_forward1, 0 },
+};
+
+static const pickplaz_fsm_transition_t app_forward1_out[] = {
+    { app_guard_left_index, app_increment_begin_indexed, APP_increment_forward2,
+      APP_FSM_NEXT_INDEX_AFTER_LEAVE_STEPS },
+};
+
+static const pickplaz_fsm_transition_t app_backward1_out[] = {
+    { app_guard_left_index, app_increment_begin_indexed, APP_increment_backward2,
+      APP_FSM_NEXT_INDEX_AFTER_LEAVE_STEPS },
+};
+
+static const pickplaz_fsm_transition_t app_forward2_out[] = {
+    { app_guard_indexed_chained, app_increment_pass, APP_increment_forward1, 0 },
+    { app_guard_indexed, app_increment_reached, APP_idle, 0 },
+};
+
+static const pickplaz_fsm_transition_t app_backward2_out[] = {
+    { app_guard_indexed_chained, app_increment_pass, APP_increment_backward1, 0 },
+    { app_guard_indexed, app_increment_reached, APP_idle, 0 },
+};
+
+static const pickplaz_fsm_transition_t app_free_forward_out[] = {
+    { app_guard_forward_released, app_increment_begin_free, APP_increment_forward2, 0 },
+};
+
+static const pickplaz_fsm_transition_t app_free_backward_out[] = {
+    { app_guard_backward_released, app_increment_begin_free, APP_increment_backward2, 0 },
+};
+
+#define APP_FSM_OUT(table) (table), (uint8_t)(sizeof(table) / sizeof((table)[0]))
+
+/**
+ * @brief Application state table, indexed by app_state_t.
+ *
+ * @details
+ * Mirrors the STM32 firmware: an increment drives until the opto leaves
+ * the index (500 steps at most), then until it returns (1500 steps at
+ * most); a held button drives continuously and finishes with the second
+ * half of an increment so the tape still stops on an index. A multi-pocket
+ * increment passes each intermediate index back into the first half
+ * without stopping, counting pockets on the index edges. Once a feeder's
+ * timing model is ready, the entry hooks shorten both timeouts to the
+ * learned durations, so a jam stops the motor within a few deviations of
+ * a normal move instead of after the full fixed timeout.
+ */
+static const pickplaz_fsm_state_t app_fsm_states[APP_STATE_COUNT] = {
+    [APP_init] = { "init", NULL, NULL, NULL, APP_FSM_OUT(app_init_out), 0, { 0 } },
+    [APP_idle] = { "idle", NULL, NULL, app_dwell_stop, APP_FSM_OUT(app_idle_out), 0, { 0 } },
+    [APP_increment_forward1] = { "increment_forward1", app_increment_enter_leave, NULL,
+                                 app_dwell_forward, APP_FSM_OUT(app_forward1_out),
+                                 APP_FSM_LEAVE_INDEX_STEPS,
+                                 { .action = app_increment_timeout, .target = APP_idle } },
+    [APP_increment_backward1] = { "increment_backward1", app_increment_enter_leave, NULL,
+                                  app_dwell_backward, APP_FSM_OUT(app_backward1_out),
+                                  APP_FSM_LEAVE_INDEX_STEPS,
+                                  { .action = app_increment_timeout, .target = APP_idle } },
+    [APP_increment_forward2] = { "increment_forward2", app_increment_enter_travel, NULL,
+                                 app_dwell_forward, APP_FSM_OUT(app_forward2_out),
+                                 APP_FSM_NEXT_INDEX_STEPS,
+                                 { .action = app_increment_timeout, .target = APP_idle } },
+    [APP_increment_backward2] = { "increment_backward2", app_increment_enter_travel, NULL,
+                                  app_dwell_backward, APP_FSM_OUT(app_backward2_out),
+                                  APP_FSM_NEXT_INDEX_STEPS,
+                                  { .action = app_increment_timeout, .target = APP_idle } },
+    [APP_free_forward] = { "free_forward", NULL, NULL, app_dwell_forward_fast,
+                           APP_FSM_OUT(app_free_forward_out), 0, { 0 } },
+    [APP_free_backward] = { "free_backward", NULL, NULL, app_dwell_backward_fast,
+                            APP_FSM_OUT(app_free_backward_out), 0, { 0 } },
+};
+
+/**
+ * @brief Advances the main application FSM.
  *
  * @details
- * Samples buttons, updates opto/feed state, advances the application and motor
- * FSMs, and refreshes LED outputs.
+ * Steps the table-driven engine over app_fsm_states, which updates the
+ * state, its timer, and motor_target from button requests, feed signals,
+ * and opto indexing status.
  *
  * Preconditions:
- * - pickplaz_app_init() has configured IO and initialized state.
+ * - fsm and request flags are initialized.
  *
- * Side effects:
- * - Reads GPIO/ADC inputs and updates PWM/GPIO outputs.
+ * Postconditions:
+ * - fsm and motor_target are updated.
  *
- * @param user_data Unused; reserved for future tick context.
+ * @param feeder Feeder to step; also the context of every guard and action.
  */
-static void app_tick(void *user_data) {
-    (void)user_data;
-    app_tick_ms++;
-#ifdef PICKPLAZ_APP_HEARTBEAT
-    if ((app_tick_ms % APP_TICK_HZ) == 0) {
-        ESP_LOGI(TAG, "Heartbeat tick=%" PRIu32 " state=%d motor=%ld opto=%" PRIu32,
-                 app_tick_ms, app_state, (long)motor_target, opto_is_indexed);
+static void run_app_fsm(pickplaz_feeder_t *feeder) {
+    pickplaz_fsm_step(&feeder->fsm);
+}
+
+static app_state_t app_state(const pickplaz_feeder_t *feeder) {
+    return (app_state_t)feeder->fsm.state;
+}
+
+/**
+ * @brief Returns the drive mode selected for the current motion phase.
+ */
+static motor_drive_t app_motor_drive(const pickplaz_feeder_t *feeder) {
+    pickplaz_app_phase_t phase = feeder->motor_profile.approaching ? PICKPLAZ_APP_PHASE_APPROACH
+                                                                   : PICKPLAZ_APP_PHASE_CRUISE;
+    return (motor_drive_t)feeder->motor_decay[phase];
+}
+
+/**
+ * @brief Starts the brake that stops a running motor.
+ *
+ * @details
+ * The planner sizes the brake from the index gap that ended the move, when
+ * that gap has just completed; otherwise it falls back to the fixed brake
+ * at the last driven duty.
+ *
+ * @param feeder Feeder whose motor is stopping.
+ */
+static void app_motor_brake_start(pickplaz_feeder_t *feeder) {
+    uint32_t gap_us = feeder->motor_speed.gap_us;
+    if (app_step_us - feeder->motor_speed.arrive_us > APP_BRAKE_GAP_AGE_US) {
+        gap_us = 0;
     }
-#endif
+    pickplaz_brake_plan_t plan = pickplaz_brake_plan(&feeder->motor_brake, feeder->motor_last_pwm,
+                                                     gap_us, feeder->opto_is_indexed != 0U);
+    feeder->motor_state = MOTOR_brake;
+    feeder->motor_timer = plan.ticks;
+    app_set_motor(feeder, plan.duty, !feeder->motor_last_forward,
+                  plan.shorted ? MOTOR_DRIVE_SHORT_BRAKE : MOTOR_DRIVE_FAST_DECAY);
+}
 
-    switch (app_button_update(&button_forward)) {
-    case BUTTON_short:
-        app_forward_request = 1;
+/**
+ * @brief Advances the motor control FSM.
+ *
+ * @details
+ * Translates the profiled motor_command into PWM outputs, applies active
+ * braking when stopping, and tracks the last commanded direction for brake
+ * polarity. The brake is planned by motor_brake and held for exactly its
+ * planned number of ticks; in the default fixed mode it reverses at the
+ * last driven duty, so a move that ends in the approach phase also brakes
+ * more gently.
+ *
+ * Preconditions:
+ * - motor_command is updated from motor_target by the motion profile.
+ *
+ * Postconditions:
+ * - PWM outputs reflect the desired motor behavior.
+ *
+ * @param feeder Feeder whose motor is driven.
+ */
+static void run_motor_fsm(pickplaz_feeder_t *feeder) {
+    pickplaz_brake_observe(&feeder->motor_brake, feeder->opto_is_indexed != 0U,
+                           feeder->motor_command != 0);
+    switch (feeder->motor_state) {
+    case MOTOR_init:
+        app_set_motor(feeder, 0, true, MOTOR_DRIVE_FAST_DECAY);
+        feeder->motor_state = MOTOR_idle;
         break;
-    case BUTTON_hold:
-        app_forward_continuous_rq = 1;
+    case MOTOR_idle:
+        app_set_motor(feeder, 0, true, MOTOR_DRIVE_FAST_DECAY);
+        if (feeder->motor_command > 0) {
+            feeder->motor_state = MOTOR_running_forward;
+        } else if (feeder->motor_command < 0) {
+            feeder->motor_state = MOTOR_running_backward;
+        }
         break;
-    case BUTTON_none:
-    case BUTTON_long:
-    default:
-        app_forward_continuous_rq = 0;
+    case MOTOR_running_forward:
+        if (feeder->motor_command == 0) {
+            app_motor_brake_start(feeder);
+        } else {
+            feeder->motor_last_pwm = (uint32_t)feeder->motor_command;
+            feeder->motor_last_forward = true;
+            app_set_motor(feeder, (uint32_t)feeder->motor_command, true, app_motor_drive(feeder));
+        }
         break;
-    }
-
-    switch (app_button_update(&button_backward)) {
-    case BUTTON_short:
-        app_backward_request = 1;
+    case MOTOR_running_backward:
+        if (feeder->motor_command == 0) {
+            app_motor_brake_start(feeder);
+        } else {
+            feeder->motor_last_pwm = (uint32_t)(-feeder->motor_command);
+            feeder->motor_last_forward = false;
+            app_set_motor(feeder, (uint32_t)(-feeder->motor_command), false,
+                          app_motor_drive(feeder));
+        }
         break;
-    case BUTTON_hold:
-        app_backward_continuous_rq = 1;
+    case MOTOR_brake:
+        if (feeder->motor_timer > 1U) {
+            feeder->motor_timer--;
+        } else {
+            feeder->motor_state = MOTOR_idle;
+            app_set_motor(feeder, 0, true, MOTOR_DRIVE_FAST_DECAY);
+        }
+        if (feeder->motor_command != 0) {
+            feeder->motor_state = MOTOR_idle;
+        }
         break;
-    case BUTTON_none:
-    case BUTTON_long:
     default:
-        app_backward_continuous_rq = 0;
+        feeder->motor_state = MOTOR_init;
         break;
     }
-
-    app_update_opto();
-    run_feed_fsm();
-    run_app_fsm();
-    run_motor_fsm();
-    eval_led_pwm();
-    eval_led_feed();
 }
 
 /**
- * @brief Configures PWM outputs for LEDs and motor channels.
+ * @brief Selects the LED animation for the current state.
  *
  * @details
- * Initializes LEDC channels only for pins that are enabled in the current
- * board pinmap.
+ * Reproduces STM32 LED patterns: idle/indexed, idle/unindexed, forward and
+ * backward motion waves, and the default sine animation. While the feed
+ * pulse is active on a board without LED4, LED3 is held at full brightness.
  *
- * Side effects:
- * - Allocates LEDC timers/channels via the HAL.
+ * @param feeder Feeder whose state is shown.
+ * @param pattern Output pattern per LED, indexed like the map's LEDs.
  */
-static void app_configure_pwm_outputs(void) {
-    if (app_pin_valid(BOARD_GPIO_LED0)) {
-        hal_pwm_init(APP_PWM_LED0_CH, BOARD_GPIO_LED0, HAL_PWM_LED_FREQ_HZ,
-                     HAL_PWM_DUTY_RES_BITS);
+static void app_led_patterns(const pickplaz_feeder_t *feeder,
+                             app_led_pattern_t pattern[APP_PWM_LED_COUNT]) {
+    for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+        pattern[i] = (app_led_pattern_t){ .wave = true };
     }
-    if (app_pin_valid(BOARD_GPIO_LED1)) {
-        hal_pwm_init(APP_PWM_LED1_CH, BOARD_GPIO_LED1, HAL_PWM_LED_FREQ_HZ,
-                     HAL_PWM_DUTY_RES_BITS);
+
+    app_state_t state = app_state(feeder);
+    if (state == APP_idle) {
+        pattern[0].wave = false;
+        pattern[3].wave = false;
+        if (feeder->opto_is_indexed) {
+            pattern[1].wave = false;
+            pattern[2].wave = false;
+            pattern[3].level = APP_PWM_STM32_MAX;
+        } else {
+            pattern[2].offset = 128;
+        }
+    } else if (state == APP_increment_forward1 || state == APP_increment_forward2 ||
+               state == APP_free_forward) {
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            pattern[i].offset = i * sine_speed;
+        }
+    } else if (state == APP_increment_backward1 || state == APP_increment_backward2 ||
+               state == APP_free_backward) {
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            pattern[i].offset = (APP_PWM_LED_COUNT - 1U - i) * sine_speed;
+        }
+    } else {
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            pattern[i].offset = i * 128;
+        }
     }
-    if (app_pin_valid(BOARD_GPIO_LED2)) {
-        hal_pwm_init(APP_PWM_LED2_CH, BOARD_GPIO_LED2, HAL_PWM_LED_FREQ_HZ,
-                     HAL_PWM_DUTY_RES_BITS);
+
+    if (feeder->feed_led_counter && !app_pin_valid(feeder->map.feed_led_pin)) {
+        pattern[3] = (app_led_pattern_t){ .level = APP_PWM_STM32_MAX };
     }
-    if (app_pin_valid(BOARD_GPIO_LED3)) {
-        hal_pwm_init(APP_PWM_LED3_CH, BOARD_GPIO_LED3, HAL_PWM_LED_FREQ_HZ,
-                     HAL_PWM_DUTY_RES_BITS);
+}
+
+static bool app_led_pattern_equal(const app_led_pattern_t *a, const app_led_pattern_t *b) {
+    if (a->wave != b->wave) {
+        return false;
     }
+    return a->wave ? (a->offset % APP_SINE_LEN) == (b->offset % APP_SINE_LEN)
+                   : a->level == b->level;
+}
 
-    if (app_pin_valid(BOARD_GPIO_MOTOR_IN1)) {
-        hal_pwm_init(APP_PWM_MOTOR_IN1_CH, BOARD_GPIO_MOTOR_IN1,
-                     HAL_PWM_MOTOR_FREQ_HZ, HAL_PWM_DUTY_RES_BITS);
+/**
+ * @brief Returns the knot that ends the fade segment containing a position.
+ *
+ * @param pos sintab index in [0, APP_SINE_LEN).
+ * @return First knot with an index greater than pos.
+ */
+static const app_led_knot_t *app_led_segment_end(uint32_t pos) {
+    size_t k = 1;
+    while (k < APP_LED_KNOT_COUNT - 1 && app_led_knots[k].index <= pos) {
+        k++;
     }
-    if (app_pin_valid(BOARD_GPIO_MOTOR_IN2)) {
-        hal_pwm_init(APP_PWM_MOTOR_IN2_CH, BOARD_GPIO_MOTOR_IN2,
-                     HAL_PWM_MOTOR_FREQ_HZ, HAL_PWM_DUTY_RES_BITS);
+    return &app_led_knots[k];
+}
+
+/**
+ * @brief Returns LED channels to the PWM frame after the fade engine failed.
+ */
+static void app_led_fade_disable(void) {
+    ESP_LOGW(TAG, "LEDC fade unavailable, LED animation falls back to the PWM frame");
+    app_led_fade = false;
+    for (size_t f = 0; f < app_feeder_count; f++) {
+        const pickplaz_feeder_map_t *map = &app_feeders[f].map;
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            if (app_pin_valid(map->led_pins[i])) {
+                app_pwm_frame.mask |= 1U << map->led_channels[i];
+            }
+        }
     }
 }
 
 /**
- * @brief Configures GPIO inputs for buttons, feed, and opto.
+ * @brief Chains the hardware fade sequence of one LED.
  *
  * @details
- * Applies active-low or active-high pull configuration based on pin settings.
+ * Does nothing between segment boundaries. At a boundary it programs a
+ * linear fade to the next knot, timed to end at that knot, so the LEDC
+ * tracks the same sintab phase the software animation would; holds and
+ * fixed levels need no fade at all. A pattern change cancels the running
+ * fade by writing the new pattern's current value directly, as the software
+ * animation would, and restarts the chain from there.
  *
- * Side effects:
- * - Configures GPIO input mode via the HAL.
+ * @param feeder Feeder owning the LED.
+ * @param index LED index in the feeder's map.
+ * @param pattern Pattern selected for this LED.
  */
-static void app_configure_inputs(void) {
-    if (app_pin_valid(button_forward.pin)) {
-        hal_gpio_config_input(button_forward.pin,
-                              app_pull_for_active_low(button_forward.active_low));
-    }
-    if (app_pin_valid(button_backward.pin)) {
+static void app_led_fade_update(pickplaz_feeder_t *feeder, uint32_t index,
+                                const app_led_pattern_t *pattern) {
+    app_led_fade_t *led = &feeder->led_fades[index];
+    int channel = feeder->map.led_channels[index];
+    uint32_t pos = (app_tick_ms + pattern->offset) % APP_SINE_LEN;
 
-        hal_gpio_config_input(button_backward.pin,
-                              app_pull_for_active_low(button_backward.active_low));
+    if (!app_led_pattern_equal(&led->pattern, pattern)) {
+        uint32_t level = pattern->wave ? sintab[pos] * APP_SINE_SCALE : pattern->level;
+        led->pattern = *pattern;
+        led->duty = app_pwm_scale(level);
+        led->pending = pattern->wave;
+        led->due_ms = app_tick_ms;
+        hal_pwm_set_duty(channel, led->duty);
     }
-    if (app_pin_valid(HAL_FEED_PIN)) {
-        hal_gpio_config_input(HAL_FEED_PIN, app_pull_for_active_low(HAL_FEED_ACTIVE_LOW));
+    if (!led->pending || (int32_t)(app_tick_ms - led->due_ms) < 0 ||
+        hal_pwm_fade_active(channel)) {
+        return;
     }
-    if (app_pin_valid(BOARD_GPIO_OPTO_INT)) {
-        hal_gpio_config_input(BOARD_GPIO_OPTO_INT,
-                              app_pull_for_active_low(!HAL_OPTO_ACTIVE_HIGH));
+
+    const app_led_knot_t *end = app_led_segment_end(pos);
+    uint32_t remaining_ms = end->index - pos;
+    uint32_t duty = app_pwm_scale(end->value * APP_SINE_SCALE);
+    if (duty != led->duty) {
+        hal_status_t status = hal_pwm_fade_start(channel, duty, remaining_ms);
+        if (status == HAL_ERR_UNSUPPORTED) {
+            app_led_fade_disable();
+            return;
+        }
+        if (status != HAL_OK) {
+            return;
+        }
     }
+    led->duty = duty;
+    led->due_ms = app_tick_ms + remaining_ms;
 }
 
 /**
- * @brief Initializes PickPlaz application state and IO.
+ * @brief Applies the LED animation for the current state.
  *
  * @details
- * Configures PWM outputs, input GPIOs, and optional ADC usage, then resets all
- * application state machines and counters.
- *
- * Preconditions:
- * - hal_init() has been called.
- *
- * Postconditions:
- * - Application state machines are reset to APP_init/MOTOR_init.
- * - GPIO/PWM resources are configured for enabled pins.
+ * By default every wave is sampled from sintab at this group's rate and
+ * written into the PWM frame. With PICKPLAZ_APP_LED_HW_FADE the same
+ * patterns run on the LEDC fade engine and this group only re-arms segments
+ * at their boundaries.
  *
  * Side effects:
- * - Configures PWM, GPIO, and ADC resources through the HAL.
- * - Logs initialization status.
- *
- * Error handling:
- * - Returns HAL_OK; initialization failures are reported via HAL logs.
+ * - Updates the LED duties of the PWM frame, or the LEDC fades directly.
  *
- * @return HAL_OK on completion.
+ * @param feeder Feeder whose LEDs are updated.
  */
-hal_status_t pickplaz_app_init(void) {
-    ESP_LOGI(TAG, "PickPlaz app init (Stage 4)");
+static void eval_led_pwm(pickplaz_feeder_t *feeder) {
+    app_led_pattern_t pattern[APP_PWM_LED_COUNT];
+    app_led_patterns(feeder, pattern);
 
-    app_configure_pwm_outputs();
-    app_configure_inputs();
-    if (app_pin_valid(BOARD_GPIO_LED4)) {
-        hal_gpio_config_output(BOARD_GPIO_LED4, HAL_GPIO_LOW);
+    for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+        if (!app_pin_valid(feeder->map.led_pins[i])) {
+            continue;
+        }
+        if (app_led_fade) {
+            app_led_fade_update(feeder, i, &pattern[i]);
+        } else {
+            uint32_t t = app_tick_ms + pattern[i].offset;
+            app_set_led_duty(feeder->map.led_channels[i],
+                             pattern[i].wave ? sintab[t % APP_SINE_LEN] * APP_SINE_SCALE
+                                             : pattern[i].level);
+        }
     }
+}
 
-    if (app_pin_valid(HAL_OPTO_ADC_CHANNEL)) {
-        hal_adc_init();
+/**
+ * @brief Drives the feed indicator LED.
+ *
+ * @details
+ * Emits a 500 ms pulse when a feed event is detected. Runs in the feed LED
+ * rate group, so the counter is decremented by the group period and the
+ * event is latched by the control group in feed_led_trigger. Uses LED4 when
+ * available; otherwise eval_led_pwm() holds LED3 on while the counter runs.
+ *
+ * Side effects:
+ * - Updates the LED4 bit of the output frame.
+ *
+ * @param feeder Feeder whose indicator is updated.
+ */
+static void eval_led_feed(pickplaz_feeder_t *feeder) {
+    const uint32_t step_ms = APP_TICK_HZ / APP_RATE_FEED_LED_HZ;
+    if (feeder->feed_led_trigger) {
+        feeder->feed_led_trigger = false;
+        feeder->feed_led_counter = APP_FEED_PULSE_MS;
     }
+    feeder->feed_led_counter =
+        (feeder->feed_led_counter > step_ms) ? feeder->feed_led_counter - step_ms : 0;
+    app_output_set(HAL_GPIO_BIT(feeder->map.feed_led_pin), feeder->feed_led_counter != 0);
+}
 
-    feed_state = FEED_fsm_low;
-    feed_signal_state = FEED_none;
-    app_state = APP_init;
-    motor_state = MOTOR_init;
-    motor_target = MOTOR_STOP;
-    motor_timer = 0;
-    motor_last_pwm = 0;
-    motor_last_forward = true;
-    feed_timer = 0;
-    feed_led_counter = 0;
-    app_tick_ms = 0;
+static bool app_opto_level_indexed(hal_gpio_level_t level) {
+    return (level == HAL_GPIO_HIGH) == (HAL_OPTO_ACTIVE_HIGH != 0);
+}
 
-    return HAL_OK;
+/** True while the motor FSM is driving the tape, i.e. opto gaps measure speed. */
+static bool app_motor_driving(const pickplaz_feeder_t *feeder) {
+    return feeder->motor_state == MOTOR_running_forward ||
+           feeder->motor_state == MOTOR_running_backward;
 }
 
 /**
- * @brief Starts the PickPlaz application tick.
+ * @brief Consumes captured opto edges and ISR cut reports.
  *
  * @details
- * Registers the 1 kHz tick callback with the HAL timer service.
- *
- * Preconditions:
- * - pickplaz_app_init() has been called.
+ * Index edges update the edge-to-edge interval used for speed estimation and
+ * the index pulse width. An index pulse shorter than a step, or one that
+ * already cut the motor in the ISR, is reported as seen even if the input
+ * snapshot has missed it.
  *
  * Postconditions:
- * - The application tick is running.
+ * - The edge ring is empty and opto_stats is current.
  *
- * Side effects:
- * - Allocates and starts a periodic timer via the HAL.
+ * @param feeder Feeder whose opto is drained.
+ * @return True if the opto reached index since the previous step.
+ */
+static bool app_opto_drain_edges(pickplaz_feeder_t *feeder) {
+    bool indexed_seen = false;
+    bool driving = app_motor_driving(feeder);
+    hal_gpio_edge_event_t event;
+    while (hal_gpio_edge_pop(feeder->map.opto_pin, &event)) {
+        feeder->opto_stats.edges++;
+        bool indexed = app_opto_level_indexed(event.level);
+        pickplaz_speed_edge(&feeder->motor_speed, indexed, event.time_us, driving);
+        if (indexed) {
+            if (feeder->opto_has_index) {
+                feeder->opto_stats.index_interval_us =
+                    (uint32_t)(event.time_us - feeder->opto_index_us);
+            }
+            feeder->opto_index_us = event.time_us;
+            feeder->opto_has_index = true;
+            indexed_seen = true;
+        } else if (feeder->opto_has_index) {
+            feeder->opto_stats.index_width_us = (uint32_t)(event.time_us - feeder->opto_index_us);
+        }
+    }
+
+    hal_gpio_edge_cut_t cut;
+    if (hal_gpio_edge_take_cut(feeder->map.opto_pin, &cut)) {
+        feeder->opto_cut_armed = false;
+        feeder->opto_stats.cuts++;
+        feeder->opto_stats.cut_latency_last_us = cut.latency_us;
+        if (cut.latency_us > feeder->opto_stats.cut_latency_max_us) {
+            feeder->opto_stats.cut_latency_max_us = cut.latency_us;
+        }
+        indexed_seen = true;
+    }
+    return indexed_seen;
+}
+
+/**
+ * @brief Arms or disarms the ISR motor cut to match the application state.
  *
- * Error handling:
- * - Returns HAL_ERR_* codes from hal_tick_start().
+ * @details
+ * While an increment is waiting for the opto to return to index, the edge
+ * ISR cuts both motor PWM channels the moment the index edge arrives, so the
+ * stop no longer waits for the next step. The normal brake sequence then
+ * runs from the motor FSM. Intermediate pockets of a chained move leave the
+ * cut disarmed, since the motor runs on through their index. The HAL is
+ * only called when the wanted state changes.
  *
- * @return HAL_OK on success, or a HAL_ERR_* code on failure.
+ * @param feeder Feeder whose opto cuts its own motor channels.
  */
-hal_status_t pickplaz_app_start(void) {
-    return hal_tick_start(APP_TICK_HZ, app_tick, NULL);
+static void app_opto_update_cut(pickplaz_feeder_t *feeder) {
+    if (!feeder->opto_edges) {
+        return;
+    }
+    app_state_t state = app_state(feeder);
+    bool want = (state == APP_increment_forward2 || state == APP_increment_backward2) &&
+                app_increment_final(feeder);
+    if (want == feeder->opto_cut_armed) {
+        return;
+    }
+    uint32_t channels =
+        want ? (1U << feeder->map.motor_in1_channel) | (1U << feeder->map.motor_in2_channel) : 0U;
+    if (hal_gpio_edge_arm_pwm_cut(feeder->map.opto_pin,
+                                  HAL_OPTO_ACTIVE_HIGH ? HAL_GPIO_HIGH : HAL_GPIO_LOW,
+                                  channels) == HAL_OK) {
+        feeder->opto_cut_armed = want;
+    }
 }
 
 /**
- * @brief Stops the PickPlaz application tick.
+ * @brief Updates opto indexing status from ADC or GPIO.
  *
  * @details
- * Cancels the periodic tick timer created by pickplaz_app_start().
+ * If the map has an opto ADC channel, uses hysteresis thresholds to avoid
+ * flapping. Otherwise uses the opto pin's bit of the input snapshot, whose
+ * polarity was normalized at init, combined with any index edge captured
+ * by interrupt since the previous step.
+ *
+ * Postconditions:
+ * - opto_is_indexed reflects the latest sampled input.
  *
  * Side effects:
- * - Stops the periodic timer via the HAL.
+ * - Reads the ADC through the HAL when configured.
+ *
+ * @param feeder Feeder whose opto is read.
  */
-void pickplaz_app_stop(void) {
-    hal_tick_stop();
+static void app_update_opto(pickplaz_feeder_t *feeder) {
+    uint32_t was_indexed = feeder->opto_is_indexed;
+    if (app_pin_valid(feeder->map.opto_adc_channel)) {
+        int adc_value = hal_adc_read(feeder->map.opto_adc_channel);
+        if (adc_value >= 0) {
+            if (feeder->opto_is_indexed) {
+                feeder->opto_is_indexed = (uint32_t)adc_value > HAL_OPTO_ADC_LOW_THRESHOLD;
+            } else {
+                feeder->opto_is_indexed = (uint32_t)adc_value > HAL_OPTO_ADC_HIGH_THRESHOLD;
+            }
+        }
+    } else if (app_pin_valid(feeder->map.opto_pin)) {
+        bool active = app_input_active(HAL_GPIO_BIT(feeder->map.opto_pin));
+        if (feeder->opto_edges && app_opto_drain_edges(feeder)) {
+            active = true;
+        }
+        feeder->opto_is_indexed = active ? 1U : 0U;
+    }
+
+    /* Without edge capture the speed loop sees level changes at step resolution. */
+    if (!feeder->opto_edges && feeder->opto_is_indexed != was_indexed) {
+        pickplaz_speed_edge(&feeder->motor_speed, feeder->opto_is_indexed != 0U, app_step_us,
+                            app_motor_driving(feeder));
+    }
+    pickplaz_speed_check(&feeder->motor_speed, app_step_us, app_motor_driving(feeder));
+}
+
+/**
+ * @brief Consumes timer and host command events.
+ *
+ * @details
+ * A feed command joins its target feeder's request queue like a decoded
+ * feed burst, so idle starts it on this step if nothing is waiting. A
+ * calibration command discards the feeder's learned timing and starts a
+ * calibration run. Timer events only exist to wake a suspended tick; the
+ * group they were armed for runs during the linger that follows every
+ * wake.
+ *
+ * Postconditions:
+ * - Both event rings are empty.
+ */
+static void app_events_drain(void) {
+    pickplaz_event_t event;
+    while (pickplaz_event_take(&app_events_host, &event)) {
+        app_load.events++;
+        if (event.type != PICKPLAZ_EVENT_COMMAND || event.target >= app_feeder_count) {
+            continue;
+        }
+        pickplaz_feeder_t *feeder = &app_feeders[event.target];
+        if (event.source == PICKPLAZ_APP_CMD_CALIBRATE) {
+            app_model_reset(feeder);
+            feeder->calib_left[0] = event.arg;
+            feeder->calib_left[1] = event.arg;
+            feeder->calibrating = true;
+        } else if (event.source == PICKPLAZ_APP_CMD_FEED_FORWARD ||
+                   event.source == PICKPLAZ_APP_CMD_FEED_BACKWARD) {
+            app_queue_feed(feeder, event.source == PICKPLAZ_APP_CMD_FEED_FORWARD, event.arg);
+        }
+    }
+    while (pickplaz_event_take(&app_events_timer, &event)) {
+        app_load.events++;
+    }
+}
+
+/**
+ * @brief Queues the next move of a calibration run.
+ *
+ * @details
+ * Each move is one pocket from rest on an index, queued only once the
+ * previous one has stopped and braked, so every sample sees the same
+ * start. The forward moves run first and the same number backward returns
+ * the tape to where it started. A feeder resting off the index is first
+ * moved forward onto the next one; that move is neither counted nor
+ * sampled. Host requests queued meanwhile run between calibration moves.
+ *
+ * @param feeder Feeder to calibrate.
+ */
+static void app_calibrate_step(pickplaz_feeder_t *feeder) {
+    if (!feeder->calibrating || app_state(feeder) != APP_idle ||
+        feeder->motor_state != MOTOR_idle || feeder->motor_brake.watching ||
+        feeder->requests.count != 0) {
+        return;
+    }
+    if (feeder->opto_is_indexed == 0U) {
+        pickplaz_queue_push(&feeder->requests, true, 1, app_step_us);
+        return;
+    }
+    for (int dir = 1; dir >= 0; dir--) {
+        if (feeder->calib_left[dir] != 0) {
+            feeder->calib_left[dir]--;
+            pickplaz_queue_push(&feeder->requests, dir != 0, 1, app_step_us);
+            return;
+        }
+    }
+    feeder->calibrating = false;
+}
+
+/**
+ * @brief Runs one control step of one feeder.
+ *
+ * @details
+ * Debounces the feeder's buttons, updates its opto and feed state, and
+ * advances its application and motor FSMs from the shared input snapshot.
+ *
+ * @param feeder Feeder to step.
+ */
+static void app_feeder_control(pickplaz_feeder_t *feeder) {
+    switch (app_button_update(&feeder->button_forward)) {
+    case PICKPLAZ_BUTTON_SHORT:
+        pickplaz_queue_push(&feeder->requests, true, 1, app_step_us);
+        break;
+    case PICKPLAZ_BUTTON_HOLD:
+        feeder->forward_continuous_rq = 1;
+        break;
+    case PICKPLAZ_BUTTON_NONE:
+    case PICKPLAZ_BUTTON_LONG:
+    default:
+        feeder->forward_continuous_rq = 0;
+        break;
+    }
+
+    switch (app_button_update(&feeder->button_backward)) {
+    case PICKPLAZ_BUTTON_SHORT:
+        pickplaz_queue_push(&feeder->requests, false, 1, app_step_us);
+        break;
+    case PICKPLAZ_BUTTON_HOLD:
+        feeder->backward_continuous_rq = 1;
+        break;
+    case PICKPLAZ_BUTTON_NONE:
+    case PICKPLAZ_BUTTON_LONG:
+    default:
+        feeder->backward_continuous_rq = 0;
+        break;
+    }
+
+    app_update_opto(feeder);
+    run_feed_fsm(feeder);
+    app_calibrate_step(feeder);
+    run_app_fsm(feeder);
+    app_opto_update_cut(feeder);
+    int32_t cruise = (int32_t)pickplaz_speed_duty(&feeder->motor_speed);
+    int32_t target = feeder->motor_target > cruise ? cruise
+                     : (feeder->motor_target < -cruise ? -cruise : feeder->motor_target);
+    feeder->motor_command = pickplaz_profile_step(&feeder->motor_profile, target);
+    run_motor_fsm(feeder);
+}
+
+/**
+ * @brief Runs the full-rate control group.
+ *
+ * @details
+ * Snapshots all GPIO inputs once, takes posted events, then steps every
+ * feeder in array order from that snapshot, timing each pass so the cost
+ * per feeder can be read back with pickplaz_app_get_feeder_stats(). Every
+ * call represents exactly APP_STEP_US of absolute time, so counters
+ * decremented here are true millisecond timers.
+ *
+ * Side effects:
+ * - Reads GPIO/ADC inputs and updates motor PWM outputs.
+ */
+static void app_group_control(void) {
+    app_inputs_sample();
+    app_events_drain();
+
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        pickplaz_feeder_t *feeder = &app_feeders[i];
+        int64_t start_us = hal_time_us();
+        app_feeder_control(feeder);
+        uint32_t elapsed_us = (uint32_t)(hal_time_us() - start_us);
+
+        feeder->stats.runs++;
+        feeder->stats.last_us = elapsed_us;
+        feeder->stats.total_us += elapsed_us;
+        if (elapsed_us > feeder->stats.max_us) {
+            feeder->stats.max_us = elapsed_us;
+        }
+    }
+}
+
+/**
+ * @brief Runs the LED animation group for every feeder.
+ */
+static void app_group_led(void) {
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        eval_led_pwm(&app_feeders[i]);
+    }
+}
+
+/**
+ * @brief Runs the feed indicator group for every feeder.
+ */
+static void app_group_feed_led(void) {
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        eval_led_feed(&app_feeders[i]);
+    }
+}
+
+static void app_group_stats(void);
+
+/**
+ * @brief Static rate-group table, in execution order within a step.
+ */
+static const app_rate_group_t app_rate_groups[] = {
+    APP_RATE_GROUP("control", APP_TICK_HZ, 0, app_group_control),
+    APP_RATE_GROUP("led", APP_RATE_LED_HZ, 1, app_group_led),
+    APP_RATE_GROUP("feed_led", APP_RATE_FEED_LED_HZ, 2, app_group_feed_led),
+    APP_RATE_GROUP("stats", APP_RATE_STATS_HZ, 3, app_group_stats),
+};
+
+#define APP_RATE_GROUP_COUNT (sizeof(app_rate_groups) / sizeof(app_rate_groups[0]))
+
+static pickplaz_app_group_stats_t app_group_stats_table[APP_RATE_GROUP_COUNT];
+static uint32_t app_group_window_max_us[APP_RATE_GROUP_COUNT];
+
+/**
+ * @brief Closes the per-group accounting window once per second.
+ *
+ * @details
+ * Publishes the worst execution time seen by each group during the last
+ * window so transient peaks can be told apart from the all-time maximum.
+ */
+static void app_group_stats(void) {
+    for (size_t i = 0; i < APP_RATE_GROUP_COUNT; i++) {
+        app_group_stats_table[i].window_max_us = app_group_window_max_us[i];
+        app_group_window_max_us[i] = 0;
+    }
+}
+
+/**
+ * @brief Executes one 1 ms application logic step.
+ *
+ * @details
+ * Dispatches every rate group whose divisor and phase match this step and
+ * accounts for its execution time. The control group runs every step; LED
+ * animation, the feed indicator, and statistics run at their declared rates
+ * on staggered phases.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has configured IO and initialized state.
+ *
+ * Side effects:
+ * - Runs the due rate groups and updates their accounting.
+ */
+static void app_step(void) {
+    app_tick_ms++;
+
+    for (size_t i = 0; i < APP_RATE_GROUP_COUNT; i++) {
+        const app_rate_group_t *group = &app_rate_groups[i];
+        if ((app_tick_ms % group->divisor) != group->phase) {
+            continue;
+        }
+
+        int64_t start_us = hal_time_us();
+        group->run();
+        uint32_t elapsed_us = (uint32_t)(hal_time_us() - start_us);
+
+        pickplaz_app_group_stats_t *stats = &app_group_stats_table[i];
+        stats->runs++;
+        stats->last_us = elapsed_us;
+        stats->total_us += elapsed_us;
+        if (elapsed_us > stats->max_us) {
+            stats->max_us = elapsed_us;
+        }
+        if (elapsed_us > app_group_window_max_us[i]) {
+            app_group_window_max_us[i] = elapsed_us;
+        }
+    }
+}
+
+/**
+ * @brief Returns true when one feeder has no periodic work to do.
+ *
+ * @details
+ * Both FSMs are idle with no brake being watched, no feed command or feed
+ * pulse is pending, no button press or feed burst is being decoded, every
+ * input can interrupt, and no LED is animated through the PWM frame. Waves
+ * on the fade engine only need a step at their next segment boundary,
+ * which app_suspend() arms a timer for. An opto read through the ADC has
+ * no interrupt and keeps the tick running.
+ *
+ * @param feeder Feeder to check.
+ * @return True when this feeder lets the tick be suspended.
+ */
+static bool app_feeder_quiescent(const pickplaz_feeder_t *feeder) {
+    const pickplaz_feeder_map_t *map = &feeder->map;
+    if (app_state(feeder) != APP_idle || feeder->motor_state != MOTOR_idle ||
+        feeder->motor_brake.watching || feeder->requests.count != 0 || feeder->calibrating ||
+        feeder->feed_led_trigger || feeder->feed_led_counter != 0) {
+        return false;
+    }
+    if (app_pin_valid(map->opto_adc_channel) ||
+        ((app_input_mask & HAL_GPIO_BIT(map->opto_pin)) != 0 && !feeder->opto_edges)) {
+        return false;
+    }
+    if ((app_input_mask & HAL_GPIO_BIT(map->feed_pin)) != 0 &&
+        (!feeder->feed_edges || pickplaz_feed_busy(&feeder->feed_decoder))) {
+        return false;
+    }
+    const app_button_t *buttons[] = { &feeder->button_forward, &feeder->button_backward };
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++) {
+        if ((app_input_mask & buttons[i]->bit) != 0 &&
+            (!buttons[i]->edges || pickplaz_button_busy(&buttons[i]->engine))) {
+            return false;
+        }
+    }
+    if (!app_led_fade) {
+        app_led_pattern_t pattern[APP_PWM_LED_COUNT];
+        app_led_patterns(feeder, pattern);
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            if (app_pin_valid(map->led_pins[i]) && pattern[i].wave) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns true when no logic step has periodic work to do.
+ *
+ * @details
+ * Every feeder is quiescent and the linger after the last wake is over.
+ *
+ * @return True when the tick may be suspended.
+ */
+static bool app_quiescent(void) {
+    if ((int32_t)(app_tick_ms - app_wake_until_ms) < 0) {
+        return false;
+    }
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        if (!app_feeder_quiescent(&app_feeders[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the earliest pending LED fade segment boundary.
+ *
+ * @param due_ms Output app_tick_ms of the boundary.
+ * @return True if any LED of any feeder has a segment to chain.
+ */
+static bool app_led_fade_next_due(uint32_t *due_ms) {
+    bool any = false;
+    for (size_t f = 0; f < app_feeder_count; f++) {
+        const pickplaz_feeder_t *feeder = &app_feeders[f];
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            const app_led_fade_t *led = &feeder->led_fades[i];
+            if (!app_pin_valid(feeder->map.led_pins[i]) || !led->pending) {
+                continue;
+            }
+            if (!any || (int32_t)(led->due_ms - *due_ms) < 0) {
+                *due_ms = led->due_ms;
+            }
+            any = true;
+        }
+    }
+    return any;
+}
+
+/**
+ * @brief Timer task callback that wakes the tick for an LED fade boundary.
+ *
+ * @param user_data Unused.
+ */
+static void app_wake_timer(void *user_data) {
+    (void)user_data;
+    pickplaz_event_t event = { .type = PICKPLAZ_EVENT_TIMER, .source = APP_TIMER_WAKE };
+    pickplaz_event_post(&app_events_timer, &event);
+    hal_tick_wake();
+}
+
+/**
+ * @brief Sets whether captured input edges wake a suspended tick.
+ *
+ * @param wake True in event-driven mode.
+ */
+static void app_configure_wake(bool wake) {
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        const pickplaz_feeder_t *feeder = &app_feeders[i];
+        if (feeder->button_forward.edges) {
+            hal_gpio_edge_set_wake(feeder->button_forward.pin, wake);
+        }
+        if (feeder->button_backward.edges) {
+            hal_gpio_edge_set_wake(feeder->button_backward.pin, wake);
+        }
+        if (feeder->feed_edges) {
+            hal_gpio_edge_set_wake(feeder->map.feed_pin, wake);
+        }
+        if (feeder->opto_edges) {
+            hal_gpio_edge_set_wake(feeder->map.opto_pin, wake);
+        }
+    }
+}
+
+/**
+ * @brief Suspends the tick until an input edge, an event, or an LED fade
+ *        boundary.
+ *
+ * @details
+ * A dispatch mode without a wake path reverts the application to polling
+ * for good; a tick that is not running (self-tests) is simply left alone.
+ */
+static void app_suspend(void) {
+    hal_status_t status = hal_tick_suspend();
+    if (status == HAL_ERR_UNSUPPORTED) {
+        ESP_LOGW(TAG, "Tick dispatch mode cannot suspend, event-driven mode disabled");
+        app_event_driven = false;
+        app_configure_wake(false);
+        return;
+    }
+    if (status != HAL_OK) {
+        return;
+    }
+    app_suspended = true;
+    app_timing.suspends++;
+
+    uint32_t due_ms;
+    if (app_led_fade && app_led_fade_next_due(&due_ms)) {
+        int32_t ahead_ms = (int32_t)(due_ms - app_tick_ms);
+        uint32_t delay_us = (ahead_ms > 0 ? (uint32_t)ahead_ms : 1U) * APP_STEP_US;
+        app_wake_timer_armed = hal_timer_start_us(APP_TIMER_WAKE, delay_us, HAL_TIMER_ONESHOT,
+                                                  app_wake_timer, NULL) == HAL_OK;
+    }
+}
+
+/**
+ * @brief Skips the steps a suspended tick did not run.
+ *
+ * @details
+ * Nothing was due while suspended, so the skipped steps are only counted:
+ * app_tick_ms still advances by them and keeps tracking absolute time. The
+ * steps that follow a wake run for at least APP_WAKE_LINGER_STEPS, so
+ * every LED group phase gets a turn before the next suspension.
+ *
+ * @param now_us Absolute time of the waking callback.
+ */
+static void app_resume(int64_t now_us) {
+    app_suspended = false;
+    app_timing.wakeups++;
+    if (app_wake_timer_armed) {
+        hal_timer_stop(APP_TIMER_WAKE);
+        app_wake_timer_armed = false;
+    }
+    if (now_us > app_next_step_us) {
+        int64_t skipped = (now_us - app_next_step_us) / APP_STEP_US;
+        app_next_step_us += skipped * APP_STEP_US;
+        app_tick_ms += (uint32_t)skipped;
+        app_timing.idle_steps += (uint32_t)skipped;
+    }
+    app_wake_until_ms = app_tick_ms + APP_WAKE_LINGER_STEPS;
+}
+
+/**
+ * @brief Runs every logic step whose deadline has passed.
+ *
+ * @details
+ * Deadlines advance in exact APP_STEP_US increments from the first call, so
+ * the logical step count tracks absolute time regardless of callback jitter.
+ * A late callback runs the missed steps back to back, at most
+ * APP_CATCHUP_MAX_STEPS per call; any remainder is carried to the next call.
+ * If the backlog exceeds APP_RESYNC_STEPS (for example after a debugger halt)
+ * the schedule is resynchronized to now and the skipped steps are counted.
+ * Outputs requested by the steps are committed once, after the last step.
+ * In event-driven mode the tick is suspended once the schedule is caught up
+ * and app_quiescent() holds, and the time until the next callback is
+ * skipped by app_resume() instead of replayed.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called.
+ * - now_us is monotonic across calls.
+ *
+ * Side effects:
+ * - Executes app_step() zero or more times.
+ * - Commits the PWM and GPIO output frames when a step ran.
+ * - Updates the timing statistics returned by pickplaz_app_get_timing().
+ * - May suspend the HAL tick and arm the LED wake timer.
+ *
+ * @param now_us Absolute time in microseconds, normally hal_time_us().
+ * @return Number of logic steps executed.
+ */
+uint32_t pickplaz_app_advance(int64_t now_us) {
+    if (!app_time_synced) {
+        app_next_step_us = now_us;
+        app_time_synced = true;
+    }
+    if (app_suspended) {
+        app_resume(now_us);
+    }
+
+    int64_t backlog = (now_us - app_next_step_us) / APP_STEP_US;
+    if (backlog >= APP_RESYNC_STEPS) {
+        app_timing.resyncs++;
+        app_timing.dropped_steps += (uint32_t)backlog;
+        app_next_step_us += backlog * APP_STEP_US;
+    }
+
+    uint32_t steps = 0;
+    while (now_us >= app_next_step_us && steps < APP_CATCHUP_MAX_STEPS) {
+        app_step_us = app_next_step_us;
+        app_step();
+        app_next_step_us += APP_STEP_US;
+        steps++;
+    }
+    if (now_us >= app_next_step_us) {
+        app_timing.deferred_steps++;
+    }
+    if (steps > 0) {
+        app_pwm_commit();
+        app_outputs_commit();
+    }
+
+    app_timing.ticks++;
+    app_timing.steps += steps;
+    if (steps > 1) {
+        app_timing.catchup_ticks++;
+    }
+    if (steps > app_timing.max_steps_per_tick) {
+        app_timing.max_steps_per_tick = steps;
+    }
+
+    app_idle = app_quiescent();
+    if (app_event_driven && app_idle && now_us < app_next_step_us) {
+        app_suspend();
+    }
+    return steps;
+}
+
+/**
+ * @brief Returns the number of scheduler rate groups.
+ *
+ * @return Number of entries accepted by pickplaz_app_get_group_stats().
+ */
+size_t pickplaz_app_group_count(void) {
+    return APP_RATE_GROUP_COUNT;
+}
+
+/**
+ * @brief Copies execution-time accounting for one rate group.
+ *
+ * @param index Group index in [0, pickplaz_app_group_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_group_stats(size_t index, pickplaz_app_group_stats_t *stats) {
+    if (index >= APP_RATE_GROUP_COUNT || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    *stats = app_group_stats_table[index];
+    stats->name = app_rate_groups[index].name;
+    stats->rate_hz = app_rate_groups[index].rate_hz;
+    stats->phase = app_rate_groups[index].phase;
+    return HAL_OK;
+}
+
+/**
+ * @brief Returns the number of application FSM states.
+ *
+ * @return State count for pickplaz_app_get_state_stats().
+ */
+size_t pickplaz_app_state_count(void) {
+    return APP_STATE_COUNT;
+}
+
+/**
+ * @brief Copies the dwell statistics of one application FSM state.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param index State index, 0..pickplaz_app_state_count() - 1.
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_state_stats(size_t feeder_index, size_t index,
+                                          pickplaz_app_state_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || index >= APP_STATE_COUNT || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    stats->name = app_fsm_states[index].name;
+    stats->entries = feeder->fsm_stats[index].entries;
+    stats->steps = feeder->fsm_stats[index].steps;
+    stats->last_steps = feeder->fsm_stats[index].last;
+    stats->max_steps = feeder->fsm_stats[index].max;
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the application timebase statistics.
+ *
+ * @param timing Output snapshot. Ignored when NULL.
+ */
+void pickplaz_app_get_timing(pickplaz_app_timing_t *timing) {
+    if (timing == NULL) {
+        return;
+    }
+    *timing = app_timing;
+}
+
+/**
+ * @brief Copies the control group's execution time for one feeder.
+ *
+ * @details
+ * Each feeder's pass is timed on its own, so the cost of adding a feeder
+ * can be read directly; the control group total in
+ * pickplaz_app_get_group_stats() adds the shared input sample.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_feeder_stats(size_t feeder_index,
+                                           pickplaz_app_feeder_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    *stats = feeder->stats;
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the feed request queue statistics of one feeder.
+ *
+ * @details
+ * Latency runs from the control step that queued a request to the step
+ * that started or extended a move with it.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_queue_stats(size_t feeder_index, pickplaz_app_queue_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    const pickplaz_queue_t *queue = &feeder->requests;
+    stats->pending = queue->count;
+    stats->queued = queue->queued;
+    stats->coalesced = queue->coalesced;
+    stats->dropped = queue->dropped;
+    stats->flushed = queue->flushed;
+    stats->high_water = queue->high_water;
+    stats->latency_last_us = feeder->queue_latency_last_us;
+    stats->latency_max_us = feeder->queue_latency_max_us;
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the opto edge capture statistics of one feeder.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_opto_stats(size_t feeder_index, pickplaz_app_opto_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    *stats = feeder->opto_stats;
+    stats->edge_capture = feeder->opto_edges;
+    if (feeder->opto_edges) {
+        stats->dropped = hal_gpio_edge_dropped(feeder->map.opto_pin);
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the debouncer statistics for one button.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param index 0 for the forward button, 1 for the backward button.
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_button_stats(size_t feeder_index, size_t index,
+                                           pickplaz_app_button_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || index > 1 || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    const app_button_t *button = (index == 0) ? &feeder->button_forward : &feeder->button_backward;
+    stats->edge_capture = button->edges;
+    stats->events = button->engine.events;
+    stats->bounces = button->engine.bounces;
+    stats->latency_last_us = button->engine.latency_last_us;
+    stats->latency_max_us = button->engine.latency_max_us;
+    return HAL_OK;
+}
+
+#ifdef PICKPLAZ_APP_HEARTBEAT
+/**
+ * @brief Logs a once-per-second heartbeat from the HAL timer wheel.
+ *
+ * @details
+ * Runs in the esp_timer task rather than the tick, so console output never
+ * delays a logic step. Values are read without locking and are advisory.
+ *
+ * @param user_data Unused.
+ */
+static void app_heartbeat(void *user_data) {
+    (void)user_data;
+    pickplaz_app_load_t load;
+    pickplaz_app_get_load(&load);
+    ESP_LOGI(TAG, "Heartbeat tick=%" PRIu32 " feeders=%u idle_cpu=%" PRIu32 "ppm", app_tick_ms,
+             (unsigned)app_feeder_count, load.idle_ppm);
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        const pickplaz_feeder_t *feeder = &app_feeders[i];
+        pickplaz_app_profile_stats_t profile;
+        pickplaz_app_get_profile_stats(i, &profile);
+        ESP_LOGI(TAG,
+                 "Feeder %u state=%d motor=%ld opto=%" PRIu32 " control_max=%" PRIu32
+                 "us index_gain=%" PRId32 "us",
+                 (unsigned)i, (int)app_state(feeder), (long)feeder->motor_target,
+                 feeder->opto_is_indexed, feeder->stats.max_us, profile.gain_us);
+    }
+}
+#endif
+
+/**
+ * @brief Charges one tick callback to the idle or active CPU account.
+ *
+ * @details
+ * The wall time since the previous callback and this callback's run time
+ * go to the account of the state the previous callback left, so a
+ * suspended stretch and the wake that ends it both count as idle.
+ *
+ * @param idle app_idle before this callback.
+ * @param start_us Callback start.
+ * @param end_us Callback end.
+ */
+static void app_load_record(bool idle, int64_t start_us, int64_t end_us) {
+    uint64_t wall_us = app_load_started ? (uint64_t)(start_us - app_load_last_us) : 0U;
+    uint64_t busy_us = (uint64_t)(end_us - start_us);
+    if (idle) {
+        app_load.idle_us += wall_us;
+        app_load.idle_busy_us += busy_us;
+    } else {
+        app_load.active_us += wall_us;
+        app_load.active_busy_us += busy_us;
+    }
+    app_load_last_us = start_us;
+    app_load_started = true;
+}
+
+static uint32_t app_load_ppm(uint64_t busy_us, uint64_t wall_us) {
+    if (wall_us == 0) {
+        return 0;
+    }
+    uint64_t ppm = (busy_us * 1000000U) / wall_us;
+    return ppm > 1000000U ? 1000000U : (uint32_t)ppm;
+}
+
+/**
+ * @brief Tick callback registered with the HAL.
+ *
+ * @details
+ * Advances the application to the current HAL time; the output frames are
+ * committed once per callback by pickplaz_app_advance(). The callback rate
+ * only bounds latency; logical time comes from the absolute timebase.
+ *
+ * @param user_data Unused; reserved for future tick context.
+ */
+static void app_tick(void *user_data) {
+    (void)user_data;
+    bool idle = app_idle;
+    int64_t start_us = hal_time_us();
+    pickplaz_app_advance(start_us);
+    app_load_record(idle, start_us, hal_time_us());
+}
+
+/**
+ * @brief Configures one PWM output and adds it to the PWM frame.
+ *
+ * @details
+ * Channels that are unused or fail to configure stay out of the frame mask,
+ * so logic writes to them are never committed.
+ *
+ * @param channel LEDC channel index.
+ * @param pin GPIO number, or BOARD_GPIO_UNUSED.
+ * @param freq_hz PWM frequency in Hertz.
+ */
+static void app_configure_pwm(int channel, int pin, uint32_t freq_hz) {
+    if (app_pin_valid(pin) &&
+        hal_pwm_init(channel, pin, freq_hz, HAL_PWM_DUTY_RES_BITS) == HAL_OK) {
+        app_pwm_frame.mask |= 1U << channel;
+    }
+}
+
+/**
+ * @brief Configures PWM outputs for LEDs and motor channels.
+ *
+ * @details
+ * Initializes LEDC channels only for pins that are enabled in each
+ * feeder's map. When both motor inputs of a feeder configure they leave
+ * the frame mask and are committed as a pair. With PICKPLAZ_APP_LED_HW_FADE
+ * the LED channels also leave the PWM frame and are driven by the hardware
+ * fade sequencer.
+ *
+ * Side effects:
+ * - Allocates LEDC timers/channels via the HAL.
+ */
+static void app_configure_pwm_outputs(void) {
+    app_pwm_frame = (hal_pwm_frame_t){ 0 };
+#ifdef PICKPLAZ_APP_LED_HW_FADE
+    app_led_fade = true;
+#else
+    app_led_fade = false;
+#endif
+    for (size_t f = 0; f < app_feeder_count; f++) {
+        pickplaz_feeder_t *feeder = &app_feeders[f];
+        const pickplaz_feeder_map_t *map = &feeder->map;
+        uint32_t led_mask = 0;
+        for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+            app_configure_pwm(map->led_channels[i], map->led_pins[i], HAL_PWM_LED_FREQ_HZ);
+            if (app_pin_valid(map->led_pins[i])) {
+                led_mask |= 1U << map->led_channels[i];
+            }
+        }
+        app_configure_pwm(map->motor_in1_channel, map->motor_in1_pin, HAL_PWM_MOTOR_FREQ_HZ);
+        app_configure_pwm(map->motor_in2_channel, map->motor_in2_pin, HAL_PWM_MOTOR_FREQ_HZ);
+
+        uint32_t motor_mask = (1U << map->motor_in1_channel) | (1U << map->motor_in2_channel);
+        feeder->motor_paired = (app_pwm_frame.mask & motor_mask) == motor_mask;
+        if (feeder->motor_paired) {
+            app_pwm_frame.mask &= ~motor_mask;
+        }
+        if (app_led_fade) {
+            app_pwm_frame.mask &= ~led_mask;
+        }
+    }
+}
+
+/**
+ * @brief Configures one GPIO input and adds it to the snapshot masks.
+ *
+ * @details
+ * Pins that are unused or fail to configure stay out of app_input_mask and
+ * therefore always read inactive.
+ *
+ * @param pin GPIO number, or BOARD_GPIO_UNUSED.
+ * @param active_low True when the input is asserted by a low level.
+ */
+static void app_configure_input(int pin, bool active_low) {
+    if (!app_pin_valid(pin)) {
+        return;
+    }
+    if (hal_gpio_config_input(pin, app_pull_for_active_low(active_low)) != HAL_OK) {
+        return;
+    }
+    app_input_mask |= HAL_GPIO_BIT(pin);
+    if (active_low) {
+        app_input_invert |= HAL_GPIO_BIT(pin);
+    }
+}
+
+/**
+ * @brief Configures plain GPIO outputs and the output frame.
+ *
+ * @details
+ * Every output starts low; only pins that configure successfully join
+ * app_output_mask, so the frame never drives a pin it does not own.
+ *
+ * Postconditions:
+ * - Output frame and shadow are cleared.
+ *
+ * Side effects:
+ * - Configures GPIO output mode via the HAL.
+ */
+static void app_configure_digital_outputs(void) {
+    app_output_mask = 0;
+    app_output_frame = 0;
+    app_output_shadow = 0;
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        int pin = app_feeders[i].map.feed_led_pin;
+        if (app_pin_valid(pin) && hal_gpio_config_output(pin, HAL_GPIO_LOW) == HAL_OK) {
+            app_output_mask |= HAL_GPIO_BIT(pin);
+        }
+    }
+}
+
+/**
+ * @brief Configures GPIO inputs for buttons, feed, and opto.
+ *
+ * @details
+ * Applies active-low or active-high pull configuration based on pin settings
+ * and precomputes the snapshot and polarity masks used by app_inputs_sample().
+ * All feeders share one snapshot.
+ *
+ * Postconditions:
+ * - app_input_mask and app_input_invert describe every configured input.
+ *
+ * Side effects:
+ * - Configures GPIO input mode via the HAL.
+ */
+static void app_configure_inputs(void) {
+    app_input_mask = 0;
+    app_input_invert = 0;
+    app_inputs = 0;
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        const pickplaz_feeder_map_t *map = &app_feeders[i].map;
+        app_configure_input(map->button_forward_pin, map->button_active_low);
+        app_configure_input(map->button_backward_pin, map->button_active_low);
+        app_configure_input(map->feed_pin, HAL_FEED_ACTIVE_LOW);
+        app_configure_input(map->opto_pin, !HAL_OPTO_ACTIVE_HIGH);
+    }
+}
+
+/**
+ * @brief Initializes a feeder's button debouncers and their edge capture.
+ *
+ * @details
+ * Buttons whose edge interrupt cannot be attached fall back to the input
+ * snapshot with the same debounce windows.
+ *
+ * Preconditions:
+ * - app_configure_inputs() has configured the button pins.
+ *
+ * @param feeder Feeder whose buttons are set up.
+ */
+static void app_configure_buttons(pickplaz_feeder_t *feeder) {
+    static const pickplaz_button_config_t config = {
+        .attack_us = APP_BUTTON_ATTACK_US,
+        .release_us = APP_BUTTON_RELEASE_US,
+        .long_us = APP_BUTTON_LONG_US,
+    };
+    app_button_t *buttons[] = { &feeder->button_forward, &feeder->button_backward };
+    const int pins[] = { feeder->map.button_forward_pin, feeder->map.button_backward_pin };
+
+    app_inputs_sample();
+    int64_t now_us = hal_time_us();
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++) {
+        app_button_t *button = buttons[i];
+        button->pin = pins[i];
+        button->active_low = feeder->map.button_active_low;
+        button->bit = HAL_GPIO_BIT(pins[i]);
+        pickplaz_button_init(&button->engine, &config, app_input_active(button->bit), now_us);
+        button->edges = (app_input_mask & button->bit) != 0 &&
+                        hal_gpio_edge_enable(button->pin, HAL_GPIO_EDGE_BOTH) == HAL_OK;
+    }
+}
+
+/**
+ * @brief Initializes a feeder's feed pulse decoder and its edge capture.
+ *
+ * Preconditions:
+ * - app_configure_inputs() has configured the feed pin.
+ *
+ * @param feeder Feeder whose feed input is set up.
+ */
+static void app_configure_feed(pickplaz_feeder_t *feeder) {
+    static const pickplaz_feed_config_t config = {
+        .min_us = HAL_FEED_MIN_US,
+        .long_us = HAL_FEED_LONG_US,
+        .max_us = HAL_FEED_MAX_US,
+        .gap_us = HAL_FEED_BURST_GAP_US,
+    };
+    int pin = feeder->map.feed_pin;
+    app_inputs_sample();
+    pickplaz_feed_init(&feeder->feed_decoder, &config, app_input_active(HAL_GPIO_BIT(pin)),
+                       hal_time_us());
+    feeder->feed_edges = (app_input_mask & HAL_GPIO_BIT(pin)) != 0 &&
+                         hal_gpio_edge_enable(pin, HAL_GPIO_EDGE_BOTH) == HAL_OK;
+}
+
+/**
+ * @brief Enables interrupt capture of opto edges when the opto is a GPIO.
+ *
+ * @details
+ * Falls back to polling the input snapshot when the opto is read through the
+ * ADC or the edge interrupt cannot be attached, e.g. because every HAL edge
+ * slot is taken by other feeders.
+ *
+ * Postconditions:
+ * - opto_edges reports whether capture is active.
+ *
+ * @param feeder Feeder whose opto is set up.
+ */
+static void app_configure_opto_capture(pickplaz_feeder_t *feeder) {
+    int pin = feeder->map.opto_pin;
+    feeder->opto_edges = !app_pin_valid(feeder->map.opto_adc_channel) &&
+                         (app_input_mask & HAL_GPIO_BIT(pin)) != 0 &&
+                         hal_gpio_edge_enable(pin, HAL_GPIO_EDGE_BOTH) == HAL_OK;
+    if (!feeder->opto_edges) {
+        ESP_LOGW(TAG, "Feeder %u opto edge capture unavailable, polling only",
+                 (unsigned)(feeder - app_feeders));
+    }
+}
+
+/**
+ * @brief Returns a feeder's state to its power-on values.
+ *
+ * @details
+ * Keeps the map and the IO flags set by the configure steps; everything
+ * else, statistics included, starts over.
+ *
+ * @param feeder Feeder to reset.
+ */
+static void app_feeder_reset(pickplaz_feeder_t *feeder) {
+    pickplaz_queue_init(&feeder->requests);
+    feeder->queue_latency_last_us = 0;
+    feeder->queue_latency_max_us = 0;
+    feeder->move_pockets = 0;
+    feeder->move_from_rest = false;
+    app_model_reset(feeder);
+    feeder->model_config = app_model_default;
+    feeder->model_timeouts = 0;
+    feeder->calib_left[0] = 0;
+    feeder->calib_left[1] = 0;
+    feeder->calibrating = false;
+    pickplaz_fsm_init(&feeder->fsm, app_fsm_states, APP_STATE_COUNT, APP_init,
+                      feeder->fsm_stats, feeder);
+    feeder->motor_state = MOTOR_init;
+    feeder->motor_target = MOTOR_STOP;
+    feeder->motor_command = MOTOR_STOP;
+    pickplaz_profile_init(&feeder->motor_profile, &app_profile_default, APP_TICK_HZ);
+    pickplaz_speed_init(&feeder->motor_speed, &app_speed_default);
+    pickplaz_brake_init(&feeder->motor_brake, &app_brake_default, APP_TICK_HZ);
+    feeder->motor_decay[PICKPLAZ_APP_PHASE_CRUISE] =
+        HAL_MOTOR_SLOW_DECAY_CRUISE ? PICKPLAZ_APP_DECAY_SLOW : PICKPLAZ_APP_DECAY_FAST;
+    feeder->motor_decay[PICKPLAZ_APP_PHASE_APPROACH] =
+        HAL_MOTOR_SLOW_DECAY_APPROACH ? PICKPLAZ_APP_DECAY_SLOW : PICKPLAZ_APP_DECAY_FAST;
+    feeder->motor_move_learn = false;
+    feeder->motor_timer = 0;
+    feeder->motor_last_pwm = 0;
+    feeder->motor_last_forward = true;
+    feeder->opto_is_indexed = 0;
+    feeder->opto_cut_armed = false;
+    feeder->opto_has_index = false;
+    feeder->opto_index_us = 0;
+    feeder->opto_stats = (pickplaz_app_opto_stats_t){ 0 };
+    feeder->forward_continuous_rq = 0;
+    feeder->backward_continuous_rq = 0;
+    for (uint32_t i = 0; i < APP_PWM_LED_COUNT; i++) {
+        feeder->led_fades[i] = (app_led_fade_t){ 0 };
+    }
+    feeder->stats = (pickplaz_app_feeder_stats_t){ 0 };
+    feeder->feed_led_counter = 0;
+    feeder->feed_led_trigger = false;
+}
+
+/**
+ * @brief Selects the feeders driven by the application.
+ *
+ * @details
+ * Replaces the board's single default feeder. All feeders share one PWM
+ * frame of HAL_PWM_FRAME_CHANNELS channels, so the LED and motor channels
+ * of every used pin must be distinct and in range; with both bridge inputs
+ * on PWM this caps a build at three motor feeders. Inputs beyond the HAL
+ * edge slots fall back to polling at init.
+ *
+ * Preconditions:
+ * - Called before pickplaz_app_init(), with the tick stopped.
+ *
+ * @param maps Pin and channel map per feeder. Must not be NULL.
+ * @param count Number of feeders, 1 to PICKPLAZ_APP_FEEDERS_MAX.
+ * @return HAL_OK on success, HAL_ERR_INVALID for a bad count or a channel
+ *         that is out of range or used twice.
+ */
+hal_status_t pickplaz_app_configure(const pickplaz_feeder_map_t *maps, size_t count) {
+    if (maps == NULL || count == 0 || count > PICKPLAZ_APP_FEEDERS_MAX) {
+        return HAL_ERR_INVALID;
+    }
+    uint32_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        const pickplaz_feeder_map_t *map = &maps[i];
+        int pins[APP_PWM_LED_COUNT + 2];
+        int channels[APP_PWM_LED_COUNT + 2];
+        for (uint32_t j = 0; j < APP_PWM_LED_COUNT; j++) {
+            pins[j] = map->led_pins[j];
+            channels[j] = map->led_channels[j];
+        }
+        pins[APP_PWM_LED_COUNT] = map->motor_in1_pin;
+        channels[APP_PWM_LED_COUNT] = map->motor_in1_channel;
+        pins[APP_PWM_LED_COUNT + 1] = map->motor_in2_pin;
+        channels[APP_PWM_LED_COUNT + 1] = map->motor_in2_channel;
+        for (size_t j = 0; j < sizeof(pins) / sizeof(pins[0]); j++) {
+            if (!app_pin_valid(pins[j])) {
+                continue;
+            }
+            if (channels[j] < 0 || channels[j] >= HAL_PWM_FRAME_CHANNELS ||
+                (used & (1U << channels[j])) != 0) {
+                return HAL_ERR_INVALID;
+            }
+            used |= 1U << channels[j];
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        app_feeders[i].map = maps[i];
+    }
+    app_feeder_count = count;
+    return HAL_OK;
+}
+
+/**
+ * @brief Returns the number of configured feeders.
+ *
+ * @return Feeder count, at least 1.
+ */
+size_t pickplaz_app_feeder_count(void) {
+    return app_feeder_count;
+}
+
+/**
+ * @brief Initializes PickPlaz application state and IO.
+ *
+ * @details
+ * Configures PWM outputs, input GPIOs, and optional ADC usage for every
+ * feeder in the map set by pickplaz_app_configure(), then resets all
+ * application state machines and counters.
+ *
+ * Preconditions:
+ * - hal_init() has been called.
+ *
+ * Postconditions:
+ * - Application state machines are reset to APP_init/MOTOR_init.
+ * - GPIO/PWM resources are configured for enabled pins.
+ *
+ * Side effects:
+ * - Configures PWM, GPIO, and ADC resources through the HAL.
+ * - Logs initialization status.
+ *
+ * Error handling:
+ * - Returns HAL_OK; initialization failures are reported via HAL logs.
+ *
+ * @return HAL_OK on completion.
+ */
+hal_status_t pickplaz_app_init(void) {
+    ESP_LOGI(TAG, "PickPlaz app init (Stage 4), %u feeder(s)", (unsigned)app_feeder_count);
+
+    app_configure_pwm_outputs();
+    app_configure_inputs();
+    bool adc = false;
+    for (size_t i = 0; i < app_feeder_count; i++) {
+        pickplaz_feeder_t *feeder = &app_feeders[i];
+        app_configure_buttons(feeder);
+        app_configure_feed(feeder);
+        app_configure_opto_capture(feeder);
+        app_feeder_reset(feeder);
+        adc = adc || app_pin_valid(feeder->map.opto_adc_channel);
+    }
+    app_configure_digital_outputs();
+
+    if (adc) {
+        hal_adc_init();
+    }
+
+    app_tick_ms = 0;
+    for (size_t i = 0; i < APP_RATE_GROUP_COUNT; i++) {
+        app_group_stats_table[i] = (pickplaz_app_group_stats_t){ 0 };
+        app_group_window_max_us[i] = 0;
+    }
+    app_time_synced = false;
+    app_timing = (pickplaz_app_timing_t){ 0 };
+
+    pickplaz_event_init(&app_events_host);
+    pickplaz_event_init(&app_events_timer);
+    app_suspended = false;
+    app_idle = false;
+    app_wake_until_ms = 0;
+    app_wake_timer_armed = false;
+    app_load = (pickplaz_app_load_t){ 0 };
+    app_load_started = false;
+    app_event_driven = HAL_APP_EVENT_DRIVEN != 0;
+    app_configure_wake(app_event_driven);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Starts the PickPlaz application tick.
+ *
+ * @details
+ * Registers the 1 kHz tick callback with the HAL timer service using the
+ * default dispatch mode from hal_config.h (a dedicated tick task, so other
+ * esp_timer users cannot delay motor control).
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called.
+ *
+ * Postconditions:
+ * - The application tick is running.
+ *
+ * Side effects:
+ * - Allocates and starts a periodic timer via the HAL.
+ *
+ * Error handling:
+ * - Returns HAL_ERR_* codes from hal_tick_start().
+ *
+ * @return HAL_OK on success, or a HAL_ERR_* code on failure.
+ */
+hal_status_t pickplaz_app_start(void) {
+#ifdef PICKPLAZ_APP_HEARTBEAT
+    hal_timer_start(APP_TIMER_HEARTBEAT, 1000, app_heartbeat, NULL);
+#endif
+    return hal_tick_start(APP_TICK_HZ, app_tick, NULL);
+}
+
+/**
+ * @brief Stops the PickPlaz application tick.
+ *
+ * @details
+ * Cancels the periodic tick timer created by pickplaz_app_start(), the LED
+ * wake timer, and the heartbeat timer when enabled.
+ *
+ * Side effects:
+ * - Stops the periodic timers via the HAL.
+ */
+void pickplaz_app_stop(void) {
+    hal_tick_stop();
+    hal_timer_stop(APP_TIMER_WAKE);
+    app_wake_timer_armed = false;
+#ifdef PICKPLAZ_APP_HEARTBEAT
+    hal_timer_stop(APP_TIMER_HEARTBEAT);
+#endif
+}
+
+/**
+ * @brief Replaces the motor motion profile, e.g. for a different tape.
+ *
+ * @details
+ * The learned pocket length and move timing are discarded, so the first
+ * move after the change runs without an approach phase and the fixed
+ * timeouts apply until the timing model is relearned.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called; the tick is stopped or this is
+ *   called from the tick context.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param config Profile limits in STM32 duty units. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID for an unknown feeder or
+ *         predictor, if a duty exceeds the PWM range, the approach/start
+ *         duties exceed the cruise duty or accel/jerk allow more than a
+ *         full-scale duty step per tick.
+ */
+hal_status_t pickplaz_app_set_profile(size_t feeder_index,
+                                      const pickplaz_profile_config_t *config) {
+    pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || config == NULL || config->cruise_duty > APP_PWM_STM32_MAX ||
+        config->approach_duty > config->cruise_duty || config->start_duty > config->cruise_duty ||
+        config->approach_permille > 1000 || config->predictor > PICKPLAZ_PROFILE_PREDICT_TIME ||
+        config->accel > (uint64_t)APP_PWM_STM32_MAX * APP_TICK_HZ ||
+        config->jerk > (uint64_t)APP_PWM_STM32_MAX * APP_TICK_HZ * APP_TICK_HZ) {
+        return HAL_ERR_INVALID;
+    }
+    pickplaz_profile_init(&feeder->motor_profile, config, APP_TICK_HZ);
+    feeder->motor_move_learn = false;
+    app_model_reset(feeder);
+    return HAL_OK;
+}
+
+/**
+ * @brief Replaces the speed loop tuning and restarts it in open loop.
+ *
+ * @details
+ * setpoint_us is the time from leaving one index to reaching the next at
+ * the wanted tape speed; 0 disables the loop and holds open_duty. The
+ * regulated duty caps the cruise duty handed to the motion profile, so the
+ * profile's start, ramp and approach shaping still apply. The learned move
+ * timing is discarded, since the tape speed changes.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called; the tick is stopped or this is
+ *   called from the tick context.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param config Speed loop tuning in STM32 duty units. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID for an unknown feeder, if the
+ *         duties are not ordered 0 < min_duty <= open_duty <= max_duty <=
+ *         the PWM range, or the timeout does not cover the setpoint.
+ */
+hal_status_t pickplaz_app_set_speed(size_t feeder_index, const pickplaz_speed_config_t *config) {
+    pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || config == NULL || config->min_duty == 0 ||
+        config->min_duty > config->open_duty ||
+        config->open_duty > config->max_duty || config->max_duty > APP_PWM_STM32_MAX ||
+        config->timeout_us <= config->setpoint_us) {
+        return HAL_ERR_INVALID;
+    }
+    pickplaz_speed_init(&feeder->motor_speed, config);
+    app_model_reset(feeder);
+    return HAL_OK;
+}
+
+/**
+ * @brief Replaces the brake mode and tuning and resets the learned model.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called; the tick is stopped or this is
+ *   called from the tick context.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param config Brake tuning in STM32 duty units and control ticks. Must
+ *        not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID for an unknown feeder or
+ *         mode, a zero length, duty or deceleration, min_duty above
+ *         max_duty, a duty beyond the PWM range, or an index window of a
+ *         whole pocket.
+ */
+hal_status_t pickplaz_app_set_brake(size_t feeder_index, const pickplaz_brake_config_t *config) {
+    pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || config == NULL || config->mode > PICKPLAZ_BRAKE_SHORT ||
+        config->fixed_ticks == 0 || config->target_ticks == 0 || config->max_ticks == 0 ||
+        config->min_duty == 0 || config->min_duty > config->max_duty ||
+        config->max_duty > APP_PWM_STM32_MAX ||
+        config->plug_decel == 0 || config->short_decel == 0 ||
+        config->index_permille >= 1000) {
+        return HAL_ERR_INVALID;
+    }
+    pickplaz_brake_init(&feeder->motor_brake, config, APP_TICK_HZ);
+    return HAL_OK;
+}
+
+/**
+ * @brief Replaces the timing model tuning and discards the learned timing.
+ *
+ * @details
+ * Until min_samples moves from rest have been timed in a direction, it
+ * keeps the fixed timeouts; PICKPLAZ_APP_CMD_CALIBRATE gets there without
+ * waiting for production moves.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called; the tick is stopped or this is
+ *   called from the tick context.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param config Model tuning. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID for an unknown feeder, an
+ *         ema_shift outside 1..8, min_samples outside 2..64, or sigma_k
+ *         above 16.
+ */
+hal_status_t pickplaz_app_set_model(size_t feeder_index, const pickplaz_model_config_t *config) {
+    pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || config == NULL || config->ema_shift < 1 || config->ema_shift > 8 ||
+        config->min_samples < 2 || config->min_samples > 64 || config->sigma_k > 16) {
+        return HAL_ERR_INVALID;
+    }
+    feeder->model_config = *config;
+    app_model_reset(feeder);
+    return HAL_OK;
+}
+
+/**
+ * @brief Selects fast or slow decay for one motion phase.
+ *
+ * @details
+ * Takes effect from the next control step. Brakes are not affected: the
+ * brake mode is chosen with pickplaz_app_set_brake(), where
+ * PICKPLAZ_BRAKE_SHORT drives both inputs high.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param phase Motion phase to configure.
+ * @param decay Decay mode for that phase.
+ * @return HAL_OK on success, HAL_ERR_INVALID for an unknown feeder, phase
+ *         or mode.
+ */
+hal_status_t pickplaz_app_set_decay(size_t feeder_index, pickplaz_app_phase_t phase,
+                                    pickplaz_app_decay_t decay) {
+    pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || (unsigned)phase >= PICKPLAZ_APP_PHASE_COUNT ||
+        decay > PICKPLAZ_APP_DECAY_SLOW) {
+        return HAL_ERR_INVALID;
+    }
+    feeder->motor_decay[phase] = decay;
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the brake planner state and learned model of one feeder.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_brake_stats(size_t feeder_index, pickplaz_app_brake_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    stats->mode = feeder->motor_brake.config.mode;
+    stats->last_duty = feeder->motor_brake.plan.duty;
+    stats->last_ticks = feeder->motor_brake.plan.ticks;
+    stats->plug_decel = feeder->motor_brake.plug_decel;
+    stats->short_decel = feeder->motor_brake.short_decel;
+    stats->stops = feeder->motor_brake.stops;
+    stats->reversals = feeder->motor_brake.reversals;
+    stats->overshoots = feeder->motor_brake.overshoots;
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the two-speed indexing statistics of one feeder.
+ *
+ * @details
+ * Covers learned moves only, which run from one index to the next. The
+ * creep time is what the same moves would have taken at the approach duty
+ * throughout, estimated from their duty-summed progress.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_profile_stats(size_t feeder_index,
+                                            pickplaz_app_profile_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    const pickplaz_profile_t *profile = &feeder->motor_profile;
+    *stats = (pickplaz_app_profile_stats_t){
+        .approaching = profile->approaching,
+        .moves = profile->moves,
+        .last_us = profile->learned_ticks * APP_STEP_US,
+    };
+    if (profile->moves != 0) {
+        stats->avg_us = (uint32_t)(profile->move_ticks * APP_STEP_US / profile->moves);
+        stats->creep_avg_us = (uint32_t)(profile->creep_ticks * APP_STEP_US / profile->moves);
+        stats->gain_us = (int32_t)stats->creep_avg_us - (int32_t)stats->avg_us;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Converts one learned model to a statistics snapshot.
+ *
+ * @param feeder Feeder whose model tuning applies.
+ * @param model Learned model.
+ * @param fallback Fixed timeout the model replaces, in steps.
+ * @return Snapshot in microseconds.
+ */
+static pickplaz_app_phase_model_t app_phase_model(const pickplaz_feeder_t *feeder,
+                                                  const pickplaz_model_t *model,
+                                                  uint32_t fallback) {
+    return (pickplaz_app_phase_model_t){
+        .samples = model->samples,
+        .mean_us = pickplaz_model_mean(model) * APP_STEP_US,
+        .sigma_us = pickplaz_model_sigma(model) * APP_STEP_US,
+        .timeout_us = pickplaz_model_timeout(model, &feeder->model_config, fallback) * APP_STEP_US,
+    };
+}
+
+/**
+ * @brief Copies the learned move timing of one feeder and direction.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param forward Direction to report.
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_model_stats(size_t feeder_index, bool forward,
+                                          pickplaz_app_model_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    const pickplaz_model_t *model = feeder->model[forward ? 1 : 0];
+    *stats = (pickplaz_app_model_stats_t){
+        .calibrating = feeder->calibrating,
+        .timeouts = feeder->model_timeouts,
+        .leave = app_phase_model(feeder, &model[APP_MODEL_LEAVE], APP_FSM_LEAVE_INDEX_STEPS),
+        .travel = app_phase_model(feeder, &model[APP_MODEL_TRAVEL],
+                                  APP_FSM_NEXT_INDEX_AFTER_LEAVE_STEPS),
+    };
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the speed loop state of one feeder.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param stats Output snapshot. Must not be NULL.
+ * @return HAL_OK on success, HAL_ERR_INVALID on invalid arguments.
+ */
+hal_status_t pickplaz_app_get_speed_stats(size_t feeder_index, pickplaz_app_speed_stats_t *stats) {
+    const pickplaz_feeder_t *feeder = app_feeder(feeder_index);
+    if (feeder == NULL || stats == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    stats->closed_loop = feeder->motor_speed.closed;
+    stats->duty = pickplaz_speed_duty(&feeder->motor_speed);
+    stats->gap_us = feeder->motor_speed.gap_us;
+    stats->samples = feeder->motor_speed.samples;
+    stats->fallbacks = feeder->motor_speed.fallbacks;
+    return HAL_OK;
+}
+
+/**
+ * @brief Selects event-driven or polled scheduling.
+ *
+ * @details
+ * In event-driven mode the tick is suspended whenever nothing moves,
+ * animates, or waits on a timed input, and resumes on a captured input
+ * edge, a posted command, or an LED fade boundary. Polled mode runs every
+ * step. Requires HAL_TICK_MODE_TASK; other dispatch modes revert to polled
+ * on the first attempt to suspend.
+ *
+ * Preconditions:
+ * - pickplaz_app_init() has been called; the tick is stopped or this is
+ *   called from the tick context.
+ *
+ * @param enable True for event-driven mode.
+ */
+void pickplaz_app_set_event_driven(bool enable) {
+    app_event_driven = enable;
+    app_configure_wake(enable);
+    if (!enable && app_suspended) {
+        hal_tick_wake();
+    }
+}
+
+/**
+ * @brief Posts a host command to one feeder.
+ *
+ * @details
+ * Lock-free: the command is queued for the next control step, which is
+ * started at once if the tick is suspended. A feed command joins the
+ * feeder's request queue like a feed burst of the same pocket count. A
+ * calibration command relearns the feeder's move timing from arg one-pocket
+ * moves forward followed by arg moves back.
+ *
+ * Preconditions:
+ * - Called from one task only; the command ring has a single producer.
+ *
+ * @param feeder_index Feeder in [0, pickplaz_app_feeder_count()).
+ * @param command Command to run.
+ * @param arg Pocket count, or calibration moves per direction; at least 1.
+ * @return HAL_OK when queued, HAL_ERR_INVALID for an unknown feeder or
+ *         command or a zero count, HAL_ERR_BUSY when the ring is full.
+ */
+hal_status_t pickplaz_app_post_command(size_t feeder_index, pickplaz_app_command_t command,
+                                       uint16_t arg) {
+    if (app_feeder(feeder_index) == NULL || (unsigned)command > PICKPLAZ_APP_CMD_CALIBRATE ||
+        arg == 0) {
+        return HAL_ERR_INVALID;
+    }
+    pickplaz_event_t event = {
+        .type = PICKPLAZ_EVENT_COMMAND,
+        .source = (uint8_t)command,
+        .target = (uint8_t)feeder_index,
+        .arg = arg,
+    };
+    if (!pickplaz_event_post(&app_events_host, &event)) {
+        return HAL_ERR_BUSY;
+    }
+    hal_tick_wake();
+    return HAL_OK;
+}
+
+/**
+ * @brief Copies the tick CPU time accounts.
+ *
+ * @details
+ * The interval since the last callback is included, so a long suspension
+ * shows up as idle time before it ends. Values are read without locking
+ * and are advisory when called outside the tick context.
+ *
+ * @param load Output snapshot. Ignored when NULL.
+ */
+void pickplaz_app_get_load(pickplaz_app_load_t *load) {
+    if (load == NULL) {
+        return;
+    }
+    *load = app_load;
+    load->event_driven = app_event_driven;
+    load->suspended = app_suspended;
+    if (app_load_started) {
+        uint64_t open_us = (uint64_t)(hal_time_us() - app_load_last_us);
+        if (app_idle) {
+            load->idle_us += open_us;
+        } else {
+            load->active_us += open_us;
+        }
+    }
+    load->idle_ppm = app_load_ppm(load->idle_busy_us, load->idle_us);
+    load->active_ppm = app_load_ppm(load->active_busy_us, load->active_us);
+    load->events_dropped = app_events_host.dropped + app_events_timer.dropped;
+}
+
+#ifdef HAL_SELFTEST
+static int64_t app_selftest_clock_us;
+
+static int64_t app_selftest_clock(void *ctx) {
+    (void)ctx;
+    return app_selftest_clock_us;
+}
+
+/**
+ * @brief Checks deterministic catch-up against a simulated clock.
+ *
+ * @details
+ * Drives app_tick() with irregular, late, and stalled callback times and
+ * verifies that logical time always equals elapsed absolute time.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_catchup(void) {
+    static const int64_t times_us[] = { 0, 1000, 1999, 2000, 7400, 7600, 9000, 9000 };
+    bool ok = true;
+
+    pickplaz_app_init();
+    hal_time_set_source(app_selftest_clock, NULL);
+    for (size_t i = 0; i < sizeof(times_us) / sizeof(times_us[0]); i++) {
+        app_selftest_clock_us = times_us[i];
+        app_tick(NULL);
+        ok = ok && app_tick_ms == (uint32_t)(times_us[i] / APP_STEP_US) + 1U;
+    }
+    ok = ok && app_timing.catchup_ticks == 2 && app_timing.max_steps_per_tick == 5;
+
+    /* A 120 ms stall drains over three callbacks at the catch-up cap. */
+    app_selftest_clock_us += 120 * APP_STEP_US;
+    app_tick(NULL);
+    ok = ok && app_timing.deferred_steps == 1;
+    app_tick(NULL);
+    app_tick(NULL);
+    ok = ok && app_tick_ms == (uint32_t)(app_selftest_clock_us / APP_STEP_US) + 1U;
+
+    /* A stall beyond the resync limit is skipped, not replayed. */
+    app_selftest_clock_us += (APP_RESYNC_STEPS + 5) * APP_STEP_US;
+    app_tick(NULL);
+    ok = ok && app_timing.resyncs == 1 && app_timing.dropped_steps == APP_RESYNC_STEPS + 4;
+    ok = ok && app_tick_ms + app_timing.dropped_steps ==
+                   (uint32_t)(app_selftest_clock_us / APP_STEP_US) + 1U;
+
+    hal_time_set_source(NULL, NULL);
+    return ok;
+}
+
+/**
+ * @brief Checks that slow rate groups never share a logic step.
+ *
+ * @return True when at most one non-control group runs on any step.
+ */
+static bool app_selftest_rate_phases(void) {
+    for (uint32_t step = 0; step < APP_TICK_HZ; step++) {
+        uint32_t slow = 0;
+        for (size_t i = 1; i < APP_RATE_GROUP_COUNT; i++) {
+            if ((step % app_rate_groups[i].divisor) == app_rate_groups[i].phase) {
+                slow++;
+            }
+        }
+        if (slow > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks the fade segments against sintab.
+ *
+ * @details
+ * Knots must be exact sintab samples covering one period, and linear
+ * interpolation between them must stay within 9 of 256 everywhere.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_led_segments(void) {
+    bool ok = app_led_knots[0].index == 0 &&
+              app_led_knots[APP_LED_KNOT_COUNT - 1].index == APP_SINE_LEN &&
+              app_led_knots[APP_LED_KNOT_COUNT - 1].value == sintab[0];
+    for (uint32_t pos = 0; pos < APP_SINE_LEN; pos++) {
+        const app_led_knot_t *end = app_led_segment_end(pos);
+        const app_led_knot_t *start = end - 1;
+        ok = ok && start->index <= pos && pos < end->index;
+        if (pos == start->index) {
+            ok = ok && sintab[pos] == start->value;
+        }
+        int32_t span = (int32_t)end->index - (int32_t)start->index;
+        int32_t lin = (int32_t)start->value +
+                      ((int32_t)end->value - (int32_t)start->value) *
+                          ((int32_t)pos - (int32_t)start->index) / span;
+        int32_t err = lin - (int32_t)sintab[pos];
+        ok = ok && err <= 9 && err >= -9;
+    }
+    return ok;
+}
+
+/**
+ * @brief Checks suspension bookkeeping and the host command path.
+ *
+ * @details
+ * Forces a one-second suspension against the simulated clock: the resume
+ * skips the idle steps instead of replaying them and the stretch is charged
+ * to the idle account. A posted two-pocket feed then starts on the next
+ * step with both pockets taken into the move.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_event_mode(void) {
+    pickplaz_app_init();
+    pickplaz_app_set_event_driven(true);
+    hal_time_set_source(app_selftest_clock, NULL);
+    app_selftest_clock_us = 0;
+    app_tick(NULL);
+
+    app_suspended = true;
+    app_idle = true;
+    app_selftest_clock_us = 1000 * APP_STEP_US;
+    app_tick(NULL);
+    bool ok = app_timing.wakeups == 1 && app_timing.idle_steps == 999 && app_tick_ms == 1001;
+    ok = ok && app_load.idle_us == 1000U * APP_STEP_US && !app_suspended && !app_quiescent();
+
+    const pickplaz_feeder_t *feeder = &app_feeders[0];
+    ok = ok && pickplaz_app_post_command(0, PICKPLAZ_APP_CMD_FEED_FORWARD, 2) == HAL_OK;
+    ok = ok && pickplaz_app_post_command(0, PICKPLAZ_APP_CMD_FEED_FORWARD, 0) == HAL_ERR_INVALID;
+    app_selftest_clock_us += APP_STEP_US;
+    app_tick(NULL);
+    ok = ok && feeder->requests.count == 0 && feeder->move_pockets == 2;
+    ok = ok && !app_quiescent();
+    ok = ok && app_load.events == 1;
+
+    hal_time_set_source(NULL, NULL);
+    pickplaz_app_init();
+    return ok;
+}
+
+/**
+ * @brief Checks that a command to one feeder leaves the others alone.
+ *
+ * @details
+ * Splits the board into two feeders: the default one without LEDs 2 and 3,
+ * and a second whose bridge takes over their PWM channels. A feed posted
+ * to the second feeder must start only its FSM and drive only its
+ * channels, and each feeder must account its own control time. A map that
+ * reuses a channel is rejected. The default map is restored afterwards.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_feeder_isolation(void) {
+    pickplaz_feeder_map_t maps[2] = { app_feeders[0].map };
+    const pickplaz_feeder_map_t board = maps[0];
+    bool ok = pickplaz_app_configure(maps, 0) == HAL_ERR_INVALID;
+    maps[1] = maps[0];
+    ok = ok && pickplaz_app_configure(maps, 2) == HAL_ERR_INVALID && app_feeder_count == 1;
+
+    maps[0].led_pins[2] = BOARD_GPIO_UNUSED;
+    maps[0].led_pins[3] = BOARD_GPIO_UNUSED;
+    maps[1] = (pickplaz_feeder_map_t){
+        .led_pins = { BOARD_GPIO_UNUSED, BOARD_GPIO_UNUSED, BOARD_GPIO_UNUSED,
+                      BOARD_GPIO_UNUSED },
+        .feed_led_pin = BOARD_GPIO_UNUSED,
+        .motor_in1_pin = BOARD_GPIO_LED2_DEFAULT,
+        .motor_in2_pin = BOARD_GPIO_LED3_DEFAULT,
+        .motor_in1_channel = APP_PWM_LED2_CH,
+        .motor_in2_channel = APP_PWM_LED3_CH,
+        .button_forward_pin = BOARD_GPIO_UNUSED,
+        .button_backward_pin = BOARD_GPIO_UNUSED,
+        .feed_pin = BOARD_GPIO_UNUSED,
+        .opto_pin = BOARD_GPIO_UNUSED,
+        .opto_adc_channel = BOARD_GPIO_UNUSED,
+    };
+    ok = ok && pickplaz_app_configure(maps, 2) == HAL_OK && pickplaz_app_feeder_count() == 2;
+    pickplaz_app_init();
+    hal_time_set_source(app_selftest_clock, NULL);
+    app_selftest_clock_us = 0;
+    ok = ok && pickplaz_app_post_command(2, PICKPLAZ_APP_CMD_FEED_FORWARD, 1) == HAL_ERR_INVALID;
+    ok = ok && pickplaz_app_post_command(1, PICKPLAZ_APP_CMD_FEED_FORWARD, 1) == HAL_OK;
+    for (int i = 0; i < 20; i++) {
+        app_selftest_clock_us += APP_STEP_US;
+        app_tick(NULL);
+    }
+    ok = ok && app_state(&app_feeders[0]) == APP_idle && app_feeders[0].motor_last_pwm == 0;
+    ok = ok && app_feeders[1].motor_target == MOTOR_FORWARD_NORMAL &&
+         app_feeders[1].motor_last_pwm != 0 && app_pwm_frame.duty[APP_PWM_LED3_CH] != 0U &&
+         app_pwm_frame.duty[maps[0].motor_in2_channel] == 0U;
+
+    pickplaz_app_feeder_stats_t stats[2];
+    ok = ok && pickplaz_app_get_feeder_stats(0, &stats[0]) == HAL_OK &&
+         pickplaz_app_get_feeder_stats(1, &stats[1]) == HAL_OK &&
+         pickplaz_app_get_feeder_stats(2, &stats[0]) == HAL_ERR_INVALID;
+    ok = ok && stats[0].runs == stats[1].runs && stats[1].runs > 0;
+
+    hal_time_set_source(NULL, NULL);
+    pickplaz_app_configure(&board, 1);
+    pickplaz_app_init();
+    return ok;
+}
+
+/**
+ * @brief Steps one feeder against a simulated tape.
+ *
+ * @details
+ * While driven the tape moves speed_permille thousandths of a unit per
+ * step in the direction of the duty, and it is on an index for the first
+ * 10 units of every 100.
+ *
+ * @param feeder Feeder to step.
+ * @param pos Tape position, updated.
+ * @param speed_permille Tape speed; 1000 for the nominal feeder, 0 jammed.
+ * @param steps Control steps to run.
+ */
+static void app_selftest_tape(pickplaz_feeder_t *feeder, int32_t *pos, uint32_t speed_permille,
+                              uint32_t steps) {
+    uint32_t travel = 0;
+    for (uint32_t i = 0; i < steps; i++) {
+        app_calibrate_step(feeder);
+        feeder->opto_is_indexed = ((*pos % 100) + 100) % 100 < 10 ? 1U : 0U;
+        run_app_fsm(feeder);
+        feeder->motor_command = pickplaz_profile_step(&feeder->motor_profile,
+                                                      feeder->motor_target);
+        run_motor_fsm(feeder);
+        if (feeder->motor_command == 0) {
+            continue;
+        }
+        travel += speed_permille;
+        if (travel >= 1000U) {
+            travel -= 1000U;
+            *pos += feeder->motor_command > 0 ? 1 : -1;
+        }
+    }
+}
+
+/**
+ * @brief Checks auto-calibration and the learned jam timeout.
+ *
+ * @details
+ * The simulated tape starts between two indexes. A calibration command
+ * must first move it onto the next index without sampling that partial
+ * pocket, run eight moves each way back to that index, and leave every
+ * model ready with timeouts far below the fixed ones. A jammed move must
+ * then time out within the learned leave timeout instead of the fixed 500
+ * steps. Once the tape runs 30% slower, one move may time out; the probe
+ * that follows must complete, and later moves must relearn the travel time
+ * without timing out again.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_calibrate(void) {
+    pickplaz_app_init();
+    pickplaz_feeder_t *feeder = &app_feeders[0];
+    int32_t pos = 50;
+    bool ok = pickplaz_app_post_command(0, PICKPLAZ_APP_CMD_CALIBRATE, 8) == HAL_OK;
+    app_events_drain();
+    ok = ok && feeder->calibrating && feeder->calib_left[1] == 8;
+    app_selftest_tape(feeder, &pos, 1000, 4000);
+
+    pickplaz_app_model_stats_t stats[2];
+    ok = ok && !feeder->calibrating && pos >= 100 && pos < 110 && feeder->model_timeouts == 0;
+    for (int dir = 0; dir < 2; dir++) {
+        ok = ok && pickplaz_app_get_model_stats(0, dir != 0, &stats[dir]) == HAL_OK;
+        ok = ok && stats[dir].leave.samples == 8 && stats[dir].travel.samples == 8;
+        ok = ok && stats[dir].travel.mean_us == 90U * APP_STEP_US &&
+             stats[dir].travel.timeout_us < 200U * APP_STEP_US;
+    }
+
+    int32_t jam_pos = pos;
+    pickplaz_queue_push(&feeder->requests, true, 1, app_step_us);
+    app_selftest_tape(feeder, &pos, 0, 100);
+    ok = ok && app_state(feeder) == APP_idle && feeder->model_timeouts == 1 && pos == jam_pos;
+
+    /* A 30% slower tape times out once, then the probe relearns the travel. */
+    for (int i = 0; i < 16; i++) {
+        pickplaz_queue_push(&feeder->requests, true, 1, app_step_us);
+        app_selftest_tape(feeder, &pos, 700, 300);
+    }
+    ok = ok && app_state(feeder) == APP_idle && pos % 100 == 0 && feeder->model_timeouts == 2;
+    ok = ok && pickplaz_app_get_model_stats(0, true, &stats[1]) == HAL_OK &&
+         stats[1].travel.mean_us > 115U * APP_STEP_US &&
+         stats[1].travel.timeout_us > 130U * APP_STEP_US;
+    pickplaz_app_init();
+    return ok;
+}
+
+typedef enum {
+    APP_SELFTEST_FWD_REQ,
+    APP_SELFTEST_BACK_REQ,
+    APP_SELFTEST_FWD_HOLD,
+    APP_SELFTEST_BACK_HOLD,
+    APP_SELFTEST_OPTO,
+    APP_SELFTEST_FEED_SHORT,
+    APP_SELFTEST_FEED_LONG,
+} app_selftest_input_t;
+
+typedef struct {
+    uint16_t step;
+    uint8_t input;
+    uint8_t value;
+} app_selftest_event_t;
+
+static const app_selftest_event_t app_selftest_fsm_events[] = {
+    { 0, APP_SELFTEST_OPTO, 1 },
+    { 10, APP_SELFTEST_FWD_REQ, 1 },      /* indexed forward move */
+    { 30, APP_SELFTEST_OPTO, 0 },
+    { 130, APP_SELFTEST_OPTO, 1 },
+    { 200, APP_SELFTEST_BACK_REQ, 1 },    /* indexed backward move */
+    { 220, APP_SELFTEST_OPTO, 0 },
+    { 330, APP_SELFTEST_OPTO, 1 },
+    { 400, APP_SELFTEST_FWD_REQ, 1 },     /* never leaves the index */
+    { 1000, APP_SELFTEST_BACK_REQ, 1 },   /* never reaches the next index */
+    { 1010, APP_SELFTEST_OPTO, 0 },
+    { 2600, APP_SELFTEST_OPTO, 1 },
+    { 2700, APP_SELFTEST_FWD_HOLD, 1 },   /* continuous forward */
+    { 2750, APP_SELFTEST_OPTO, 0 },
+    { 2800, APP_SELFTEST_FWD_HOLD, 0 },
+    { 2900, APP_SELFTEST_OPTO, 1 },
+    { 3000, APP_SELFTEST_BACK_HOLD, 1 },  /* continuous backward, index lost */
+    { 3050, APP_SELFTEST_OPTO, 0 },
+    { 3100, APP_SELFTEST_BACK_HOLD, 0 },
+    { 4700, APP_SELFTEST_OPTO, 1 },
+    { 4800, APP_SELFTEST_FEED_SHORT, 2 }, /* two-pocket feed */
+    { 4810, APP_SELFTEST_OPTO, 0 },
+    { 4850, APP_SELFTEST_OPTO, 1 },
+    { 4860, APP_SELFTEST_OPTO, 0 },
+    { 4900, APP_SELFTEST_OPTO, 1 },
+    { 5000, APP_SELFTEST_FEED_LONG, 1 },
+    { 5010, APP_SELFTEST_OPTO, 0 },
+    { 5050, APP_SELFTEST_OPTO, 1 },
+    { 5200, APP_SELFTEST_FWD_REQ, 1 },    /* both requests: run in arrival order */
+    { 5200, APP_SELFTEST_BACK_REQ, 1 },
+    { 5210, APP_SELFTEST_OPTO, 0 },
+    { 5250, APP_SELFTEST_OPTO, 1 },
+    { 5260, APP_SELFTEST_OPTO, 0 },
+    { 5300, APP_SELFTEST_OPTO, 1 },
+    { 5400, APP_SELFTEST_FWD_REQ, 1 },    /* request and hold: hold wins */
+    { 5400, APP_SELFTEST_FWD_HOLD, 1 },
+    { 5500, APP_SELFTEST_FWD_HOLD, 0 },
+};
+
+enum { APP_SELFTEST_FSM_STEPS = 5600 };
+
+static void app_selftest_fsm_apply(pickplaz_feeder_t *feeder, const app_selftest_event_t *event) {
+    switch (event->input) {
+    case APP_SELFTEST_FWD_REQ:
+    case APP_SELFTEST_BACK_REQ:
+        pickplaz_queue_push(&feeder->requests, event->input == APP_SELFTEST_FWD_REQ, event->value,
+                            app_step_us);
+        break;
+    case APP_SELFTEST_FWD_HOLD:
+        feeder->forward_continuous_rq = event->value;
+        break;
+    case APP_SELFTEST_BACK_HOLD:
+        feeder->backward_continuous_rq = event->value;
+        break;
+    case APP_SELFTEST_OPTO:
+        feeder->opto_is_indexed = event->value;
+        break;
+    case APP_SELFTEST_FEED_SHORT:
+    case APP_SELFTEST_FEED_LONG:
+        app_queue_feed(feeder, event->input == APP_SELFTEST_FEED_SHORT, event->value);
+        break;
+    default:
+        break;
+    }
+}
+
+typedef struct {
+    uint16_t step;
+    uint8_t state;
+    int16_t target;
+} app_selftest_trace_t;
+
+/**
+ * @brief Expected application state and motor target of the FSM trace.
+ *
+ * @details
+ * Recorded from the switch-based FSM this table replaced; one entry per
+ * change. The two-pocket feed at 4800 now runs through the index at 4850
+ * instead of stopping there for a step, and the requests at 5200 are
+ * queued and run in turn instead of the backward one taking both.
+ */
+static const app_selftest_trace_t app_selftest_fsm_golden[] = {
+    { 0, APP_idle, MOTOR_STOP },
+    { 10, APP_increment_forward1, MOTOR_STOP },
+    { 11, APP_increment_forward1, MOTOR_FORWARD_NORMAL },
+    { 30, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 130, APP_idle, MOTOR_STOP },
+    { 200, APP_increment_backward1, MOTOR_STOP },
+    { 201, APP_increment_backward1, MOTOR_BACKWARD_NORMAL },
+    { 220, APP_increment_backward2, MOTOR_BACKWARD_NORMAL },
+    { 330, APP_idle, MOTOR_STOP },
+    { 400, APP_increment_forward1, MOTOR_STOP },
+    { 401, APP_increment_forward1, MOTOR_FORWARD_NORMAL },
+    { 901, APP_idle, MOTOR_FORWARD_NORMAL },
+    { 902, APP_idle, MOTOR_STOP },
+    { 1000, APP_increment_backward1, MOTOR_STOP },
+    { 1001, APP_increment_backward1, MOTOR_BACKWARD_NORMAL },
+    { 1010, APP_increment_backward2, MOTOR_BACKWARD_NORMAL },
+    { 2510, APP_idle, MOTOR_BACKWARD_NORMAL },
+    { 2511, APP_idle, MOTOR_STOP },
+    { 2700, APP_free_forward, MOTOR_STOP },
+    { 2701, APP_free_forward, MOTOR_FORWARD_NORMAL },
+    { 2800, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 2900, APP_idle, MOTOR_STOP },
+    { 3000, APP_free_backward, MOTOR_STOP },
+    { 3001, APP_free_backward, MOTOR_BACKWARD_NORMAL },
+    { 3100, APP_increment_backward2, MOTOR_BACKWARD_NORMAL },
+    { 4601, APP_idle, MOTOR_BACKWARD_NORMAL },
+    { 4602, APP_idle, MOTOR_STOP },
+    { 4800, APP_increment_forward1, MOTOR_STOP },
+    { 4801, APP_increment_forward1, MOTOR_FORWARD_NORMAL },
+    { 4810, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 4850, APP_increment_forward1, MOTOR_FORWARD_NORMAL },
+    { 4860, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 4900, APP_idle, MOTOR_STOP },
+    { 5000, APP_increment_backward1, MOTOR_STOP },
+    { 5001, APP_increment_backward1, MOTOR_BACKWARD_NORMAL },
+    { 5010, APP_increment_backward2, MOTOR_BACKWARD_NORMAL },
+    { 5050, APP_idle, MOTOR_STOP },
+    { 5200, APP_increment_forward1, MOTOR_STOP },
+    { 5201, APP_increment_forward1, MOTOR_FORWARD_NORMAL },
+    { 5210, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 5250, APP_idle, MOTOR_STOP },
+    { 5251, APP_increment_backward1, MOTOR_STOP },
+    { 5252, APP_increment_backward1, MOTOR_BACKWARD_NORMAL },
+    { 5260, APP_increment_backward2, MOTOR_BACKWARD_NORMAL },
+    { 5300, APP_idle, MOTOR_STOP },
+    { 5400, APP_free_forward, MOTOR_STOP },
+    { 5401, APP_free_forward, MOTOR_FORWARD_NORMAL },
+    { 5500, APP_increment_forward2, MOTOR_FORWARD_NORMAL },
+    { 5501, APP_idle, MOTOR_STOP },
+};
+
+/**
+ * @brief Replays scripted inputs through the application FSM.
+ *
+ * @details
+ * Covers indexed moves both ways, both timeouts, continuous moves, a
+ * two-pocket feed, a long feed pulse, and simultaneous requests. The
+ * state and motor target after every step must match the golden trace.
+ *
+ * @return True when the trace matches.
+ */
+static bool app_selftest_fsm_trace(void) {
+    const size_t event_count =
+        sizeof(app_selftest_fsm_events) / sizeof(app_selftest_fsm_events[0]);
+    const size_t golden_count =
+        sizeof(app_selftest_fsm_golden) / sizeof(app_selftest_fsm_golden[0]);
+    size_t next_event = 0;
+    size_t matched = 0;
+    bool ok = true;
+
+    pickplaz_app_init();
+    pickplaz_feeder_t *feeder = &app_feeders[0];
+    for (uint16_t step = 0; step < APP_SELFTEST_FSM_STEPS; step++) {
+        while (next_event < event_count && app_selftest_fsm_events[next_event].step == step) {
+            app_selftest_fsm_apply(feeder, &app_selftest_fsm_events[next_event++]);
+        }
+        run_app_fsm(feeder);
+
+        const app_selftest_trace_t *expect = &app_selftest_fsm_golden[matched];
+        if (matched < golden_count && expect->step == step) {
+            ok = ok && app_state(feeder) == expect->state && feeder->motor_target == expect->target;
+            matched++;
+        } else if (matched > 0) {
+            expect = &app_selftest_fsm_golden[matched - 1];
+            ok = ok && app_state(feeder) == expect->state && feeder->motor_target == expect->target;
+        }
+    }
+    ok = ok && matched == golden_count && feeder->fsm_stats[APP_idle].entries == 12;
+    pickplaz_app_init();
+    return ok;
+}
+
+/**
+ * @brief Checks the bridge input duties of each motor drive mode.
+ *
+ * @return True when every check passes.
+ */
+static bool app_selftest_motor_drive(void) {
+    hal_pwm_frame_t saved = app_pwm_frame;
+    uint32_t full = app_pwm_max();
+    uint32_t quarter = app_pwm_scale(APP_PWM_STM32_MAX / 4);
+    pickplaz_feeder_t *feeder = &app_feeders[0];
+    uint32_t *in1 = &app_pwm_frame.duty[feeder->map.motor_in1_channel];
+    uint32_t *in2 = &app_pwm_frame.duty[feeder->map.motor_in2_channel];
+
+    app_set_motor(feeder, APP_PWM_STM32_MAX / 4, true, MOTOR_DRIVE_FAST_DECAY);
+    bool ok = *in1 == 0U && *in2 == quarter;
+    app_set_motor(feeder, APP_PWM_STM32_MAX / 4, true, MOTOR_DRIVE_SLOW_DECAY);
+    ok = ok && *in1 == full - quarter && *in2 == full;
+    app_set_motor(feeder, APP_PWM_STM32_MAX / 4, false, MOTOR_DRIVE_SLOW_DECAY);
+    ok = ok && *in1 == full && *in2 == full - quarter;
+    app_set_motor(feeder, APP_PWM_STM32_MAX, false, MOTOR_DRIVE_SHORT_BRAKE);
+    ok = ok && *in1 == full && *in2 == full;
+
+    app_pwm_frame = saved;
+    return ok;
+}
+#endif
+
+/**
+ * @brief Runs application self-tests against simulated inputs.
+ *
+ * @details
+ * Exercises timing logic without real hardware time. Only compiled when
+ * HAL_SELFTEST is defined; application state is left reset-ready and must be
+ * re-initialized with pickplaz_app_init() before starting.
+ *
+ * Side effects:
+ * - Drives PWM/GPIO outputs while simulated steps run.
+ * - Writes test results to the log.
+ */
+void pickplaz_app_selftest_run(void) {
+#ifndef HAL_SELFTEST
+    return;
+#else
+    ESP_LOGI(TAG, "App self-test start");
+    ESP_LOGI(TAG, "Timebase catch-up: %s", app_selftest_catchup() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Rate group phases: %s", app_selftest_rate_phases() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Button bounce replay: %s", pickplaz_button_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Feed pulse decode: %s", pickplaz_feed_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "LED fade segments: %s", app_selftest_led_segments() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Motion profile: %s", pickplaz_profile_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Speed loop: %s", pickplaz_speed_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Adaptive brake: %s", pickplaz_brake_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Motor decay modes: %s", app_selftest_motor_drive() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "FSM engine: %s", pickplaz_fsm_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "App FSM golden trace: %s", app_selftest_fsm_trace() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Event ring: %s", pickplaz_event_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Feed request queue: %s", pickplaz_queue_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Event-driven idle: %s", app_selftest_event_mode() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Feeder isolation: %s", app_selftest_feeder_isolation() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Timing model: %s", pickplaz_model_selftest() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "Auto-calibration: %s", app_selftest_calibrate() ? "PASS" : "FAIL");
+    ESP_LOGI(TAG, "App self-test complete");
+#endif
 }
@@ -0,0 +1,263 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_brake.c
+ * @brief Speed-dependent motor brake with a learned deceleration model.
+ *
+ * @details
+ * The approach speed is taken from the index gap that ended the move. A
+ * plug brake picks the reverse duty that removes that speed in target_ticks
+ * under the learned deceleration, then the length needed at the clamped
+ * duty; a short brake only picks a length. The model is corrected from what
+ * the opto sees after a stop on index. The opto triggers at the leading
+ * edge of the index, so the tape can only leave the far side after covering
+ * the whole window, which takes at least the window's share of the gap at
+ * approach speed. Losing the index sooner means the brake reversed the tape
+ * back out (model too weak, shorten); losing it later means the tape
+ * coasted through (model too strong, lengthen). Each correction moves the
+ * deceleration by 1/8 within 1/4..4 times its configured value.
+ *
+ * Thread-safety:
+ * - Not thread-safe; plan and observe from one context.
+ */
+
+#include "pickplaz_brake.h"
+
+#define PICKPLAZ_BRAKE_FULL 2048U
+
+static uint32_t pickplaz_brake_clamp(uint32_t value, uint32_t lo, uint32_t hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+static uint32_t pickplaz_brake_div_up(uint64_t num, uint64_t den) {
+    return (uint32_t)((num + den - 1U) / den);
+}
+
+/**
+ * @brief Initializes a planner with the configured model.
+ *
+ * @param brake Planner state. Must not be NULL.
+ * @param config Tuning, copied. Must not be NULL.
+ * @param tick_hz Rate at which pickplaz_brake_observe() is called.
+ */
+void pickplaz_brake_init(pickplaz_brake_t *brake, const pickplaz_brake_config_t *config,
+                         uint32_t tick_hz) {
+    *brake = (pickplaz_brake_t){0};
+    brake->config = *config;
+    brake->tick_hz = tick_hz;
+    brake->plug_decel = config->plug_decel;
+    brake->short_decel = config->short_decel;
+}
+
+/**
+ * @brief Plans the brake for a motor that is being stopped.
+ *
+ * @details
+ * FIXED mode, and any stop without a measured gap, reverses at last_duty
+ * for fixed_ticks. Adaptive stops on index start a watch, continued by
+ * pickplaz_brake_observe(), that feeds the model.
+ *
+ * @param brake Planner state. Must not be NULL.
+ * @param last_duty Duty driven on the tick before the stop, STM32 units.
+ * @param gap_us Index gap that ended this move; 0 when not measured.
+ * @param indexed True when the stop is on an index.
+ * @return Brake to apply.
+ */
+pickplaz_brake_plan_t pickplaz_brake_plan(pickplaz_brake_t *brake, uint32_t last_duty,
+                                          uint32_t gap_us, bool indexed) {
+    const pickplaz_brake_config_t *cfg = &brake->config;
+    pickplaz_brake_plan_t plan = { .duty = last_duty, .ticks = cfg->fixed_ticks };
+    brake->watching = false;
+    if (cfg->mode == PICKPLAZ_BRAKE_FIXED || gap_us == 0) {
+        brake->plan = plan;
+        return plan;
+    }
+
+    uint64_t speed = 1000000000ULL / gap_us;
+    if (cfg->mode == PICKPLAZ_BRAKE_SHORT) {
+        plan.shorted = true;
+        plan.duty = PICKPLAZ_BRAKE_FULL;
+        plan.ticks = pickplaz_brake_div_up(speed, brake->short_decel);
+    } else {
+        /* Duty-ticks product that removes the speed at the learned deceleration. */
+        uint64_t need = pickplaz_brake_div_up(speed * PICKPLAZ_BRAKE_FULL, brake->plug_decel);
+        plan.duty = pickplaz_brake_clamp(pickplaz_brake_div_up(need, cfg->target_ticks),
+                                         cfg->min_duty, cfg->max_duty);
+        plan.ticks = pickplaz_brake_div_up(need, plan.duty);
+    }
+    plan.ticks = pickplaz_brake_clamp(plan.ticks, 1U, cfg->max_ticks);
+
+    /* Earliest tick the tape could clear the far side of the window. */
+    uint64_t pass_us = ((uint64_t)gap_us * cfg->index_permille) / (1000U - cfg->index_permille);
+    brake->pass_ticks = (uint32_t)((pass_us * brake->tick_hz) / 1000000U);
+
+    brake->plan = plan;
+    brake->watching = indexed;
+    brake->elapsed = 0;
+    return plan;
+}
+
+static void pickplaz_brake_learn(pickplaz_brake_t *brake, bool stronger) {
+    bool shorted = brake->plan.shorted;
+    uint32_t *decel = shorted ? &brake->short_decel : &brake->plug_decel;
+    uint32_t base = shorted ? brake->config.short_decel : brake->config.plug_decel;
+    uint32_t step = *decel / 8U ? *decel / 8U : 1U;
+    uint32_t next = stronger ? *decel + step : *decel - step;
+    *decel = pickplaz_brake_clamp(next, base / 4U ? base / 4U : 1U, base * 4U);
+}
+
+/**
+ * @brief Watches the opto after an adaptive stop and corrects the model.
+ *
+ * @details
+ * Call once per control tick, after the tick on which the brake was
+ * planned. A new motor command ends the watch without learning.
+ *
+ * @param brake Planner state. Must not be NULL.
+ * @param indexed Current opto level, true when on an index.
+ * @param commanded True when the motor has been commanded to move again.
+ */
+void pickplaz_brake_observe(pickplaz_brake_t *brake, bool indexed, bool commanded) {
+    if (!brake->watching) {
+        return;
+    }
+    if (commanded) {
+        brake->watching = false;
+        return;
+    }
+    brake->elapsed++;
+    if (!indexed) {
+        brake->watching = false;
+        if (brake->elapsed < brake->pass_ticks) {
+            brake->reversals++;
+            pickplaz_brake_learn(brake, true);
+        } else {
+            brake->overshoots++;
+            pickplaz_brake_learn(brake, false);
+        }
+        return;
+    }
+    if (brake->elapsed >= brake->plan.ticks + brake->config.settle_ticks) {
+        brake->watching = false;
+        brake->stops++;
+    }
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Simulated tape stopping on an index, 1 ms ticks.
+ *
+ * @details
+ * Position is in millionths of a gap from the index edge, so speed in
+ * thousandths of a gap per second is also the distance per tick. A plug
+ * brake removes decel * duty / 2048 per tick and can drive the tape
+ * backwards; a short brake removes decel per tick down to rest; after
+ * release friction removes drag per tick. The index window is a quarter
+ * pocket, a third of the gap.
+ */
+typedef struct {
+    int32_t plug_decel;
+    int32_t short_decel;
+    int32_t drag;
+} pickplaz_brake_sim_t;
+
+/**
+ * @brief Runs one stop on index and feeds the opto to the planner.
+ *
+ * @param sim Plant.
+ * @param brake Planner under test.
+ * @param gap_us Index gap of the approach.
+ * @return True when the tape stayed on the index.
+ */
+static bool pickplaz_brake_sim_stop(const pickplaz_brake_sim_t *sim, pickplaz_brake_t *brake,
+                                    uint32_t gap_us) {
+    int32_t vel = (int32_t)(1000000000ULL / gap_us);
+    int32_t pos = 0;
+    bool held = true;
+    pickplaz_brake_plan_t plan = pickplaz_brake_plan(brake, 1024, gap_us, true);
+    for (uint32_t tick = 1; tick <= plan.ticks + brake->config.settle_ticks + 20U; tick++) {
+        int32_t slow;
+        if (tick <= plan.ticks && !plan.shorted) {
+            slow = (int32_t)(((int64_t)sim->plug_decel * plan.duty) / PICKPLAZ_BRAKE_FULL);
+            vel -= slow;
+        } else {
+            slow = (tick <= plan.ticks) ? sim->short_decel : sim->drag;
+            vel = vel > slow ? vel - slow : (vel < -slow ? vel + slow : 0);
+        }
+        pos += vel;
+        bool indexed = pos >= 0 && pos < 333333;
+        held = held && indexed;
+        pickplaz_brake_observe(brake, indexed, false);
+    }
+    return held;
+}
+
+/**
+ * @brief Checks FIXED planning and model convergence from both sides.
+ *
+ * @details
+ * Plants twice as strong (reversing) and an eighth as strong (coasting) as
+ * the configured plug model must each be learned until stops hold the index.
+ * A short brake against a weak plant must lengthen until it holds, and an
+ * unknown speed falls back to the fixed brake.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_brake_selftest(void) {
+    static const pickplaz_brake_config_t config = {
+        .mode = PICKPLAZ_BRAKE_PLUG,
+        .fixed_ticks = 8,
+        .target_ticks = 4,
+        .min_duty = 256,
+        .max_duty = 2048,
+        .max_ticks = 40,
+        .plug_decel = 1600,
+        .short_decel = 400,
+        .settle_ticks = 100,
+        .index_permille = 250,
+    };
+    static const pickplaz_brake_sim_t plants[] = {
+        { .plug_decel = 3200, .short_decel = 400, .drag = 200 },
+        { .plug_decel = 200, .short_decel = 200, .drag = 40 },
+    };
+    pickplaz_brake_t brake;
+    bool ok = true;
+
+    for (unsigned p = 0; p < sizeof(plants) / sizeof(plants[0]); p++) {
+        pickplaz_brake_init(&brake, &config, 1000);
+        ok = ok && !pickplaz_brake_sim_stop(&plants[p], &brake, 150000);
+        for (int i = 0; i < 20; i++) {
+            pickplaz_brake_sim_stop(&plants[p], &brake, 150000);
+        }
+        uint32_t faults = brake.reversals + brake.overshoots;
+        for (int i = 0; i < 5; i++) {
+            ok = ok && pickplaz_brake_sim_stop(&plants[p], &brake, 150000);
+        }
+        ok = ok && faults > 0 && brake.reversals + brake.overshoots == faults;
+        ok = ok && (p == 0 ? brake.plug_decel > config.plug_decel
+                           : brake.plug_decel < config.plug_decel);
+    }
+
+    pickplaz_brake_config_t shorted = config;
+    shorted.mode = PICKPLAZ_BRAKE_SHORT;
+    shorted.short_decel = 800;
+    pickplaz_brake_init(&brake, &shorted, 1000);
+    ok = ok && !pickplaz_brake_sim_stop(&plants[1], &brake, 150000);
+    for (int i = 0; i < 20; i++) {
+        pickplaz_brake_sim_stop(&plants[1], &brake, 150000);
+    }
+    ok = ok && pickplaz_brake_sim_stop(&plants[1], &brake, 150000) && brake.plan.shorted &&
+         brake.short_decel < shorted.short_decel;
+
+    pickplaz_brake_plan_t plan = pickplaz_brake_plan(&brake, 700, 0, true);
+    ok = ok && !plan.shorted && plan.duty == 700 && plan.ticks == 8 && !brake.watching;
+    return ok;
+}
+#endif
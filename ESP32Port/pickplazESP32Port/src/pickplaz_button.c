@@ -0,0 +1,238 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_button.c
+ * @brief Timestamp-based button debouncer fed by input edges.
+ *
+ * @details
+ * Replaces tick-counter debouncing with stable-time windows measured between
+ * edge timestamps: a press is accepted once the input has stayed active for
+ * the attack window, a release once it has stayed inactive for the release
+ * window, and any edge inside a window restarts it. Short/long/hold
+ * semantics match the original STM32 button model. The module has no
+ * platform dependencies, so it can be driven from recorded waveforms on a
+ * host as well as from GPIO edge interrupts on target.
+ *
+ * Thread-safety:
+ * - Not thread-safe; each button must be fed and polled from one context.
+ */
+
+#include "pickplaz_button.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Initializes a button at a known input level.
+ *
+ * @details
+ * An input that is already active at init is treated as an edge at now_us,
+ * so it must still satisfy the attack window before it counts as a press.
+ *
+ * @param button Button state. Must not be NULL.
+ * @param config Debounce configuration, copied. Must not be NULL.
+ * @param active Current input level, true when asserted.
+ * @param now_us Current time in microseconds.
+ */
+void pickplaz_button_init(pickplaz_button_t *button, const pickplaz_button_config_t *config,
+                          bool active, int64_t now_us) {
+    *button = (pickplaz_button_t){0};
+    button->config = *config;
+    button->raw = active;
+    button->raw_us = now_us;
+}
+
+/**
+ * @brief Records an input edge.
+ *
+ * @details
+ * Edges may repeat the current level when the edge source missed the
+ * intermediate transition (e.g. a bounce shorter than the ISR latency); they
+ * still restart the stable window.
+ *
+ * @param button Button state. Must not be NULL.
+ * @param active Input level after the edge, true when asserted.
+ * @param time_us Edge timestamp in microseconds.
+ */
+void pickplaz_button_edge(pickplaz_button_t *button, bool active, int64_t time_us) {
+    if (button->raw != button->pressed || active == button->raw) {
+        button->bounces++;
+    }
+    button->raw = active;
+    button->raw_us = time_us;
+}
+
+/**
+ * @brief Reports whether the button needs polling.
+ *
+ * @details
+ * An idle, released button with no pending edge produces no events, so
+ * callers can skip pickplaz_button_poll() until the next edge arrives.
+ *
+ * @param button Button state. Must not be NULL.
+ * @return True while a window is open or the button is pressed.
+ */
+bool pickplaz_button_busy(const pickplaz_button_t *button) {
+    return button->pressed || button->raw != button->pressed;
+}
+
+static void pickplaz_button_record(pickplaz_button_t *button, int64_t decided_us,
+                                   int64_t now_us) {
+    uint32_t latency = now_us > decided_us ? (uint32_t)(now_us - decided_us) : 0U;
+    button->events++;
+    button->latency_last_us = latency;
+    if (latency > button->latency_max_us) {
+        button->latency_max_us = latency;
+    }
+}
+
+/**
+ * @brief Advances the debouncer to now_us and returns any event.
+ *
+ * @details
+ * SHORT and LONG are reported when a release is accepted, classified by the
+ * time between the press and release edges. HOLD is reported on every poll
+ * once the press has lasted longer than long_us. Latency is measured from
+ * the moment the event became decidable (edge plus window, or press plus
+ * long_us) to the poll that returned it, so it reflects poll granularity.
+ *
+ * @param button Button state. Must not be NULL.
+ * @param now_us Current time in microseconds.
+ * @return Event for this poll.
+ */
+pickplaz_button_event_t pickplaz_button_poll(pickplaz_button_t *button, int64_t now_us) {
+    if (!pickplaz_button_busy(button)) {
+        return PICKPLAZ_BUTTON_NONE;
+    }
+
+    if (button->raw != button->pressed) {
+        uint32_t window = button->raw ? button->config.attack_us : button->config.release_us;
+        int64_t settled_us = button->raw_us + window;
+        if (now_us >= settled_us) {
+            if (button->raw) {
+                button->pressed = true;
+                button->press_us = button->raw_us;
+                button->holding = false;
+            } else {
+                int64_t held_us = button->raw_us - button->press_us;
+                button->pressed = false;
+                pickplaz_button_record(button, settled_us, now_us);
+                return (held_us > (int64_t)button->config.long_us) ? PICKPLAZ_BUTTON_LONG
+                                                                    : PICKPLAZ_BUTTON_SHORT;
+            }
+        }
+    }
+
+    if (button->pressed) {
+        int64_t long_at_us = button->press_us + (int64_t)button->config.long_us;
+        if (now_us > long_at_us) {
+            if (!button->holding) {
+                button->holding = true;
+                pickplaz_button_record(button, long_at_us, now_us);
+            }
+            return PICKPLAZ_BUTTON_HOLD;
+        }
+    }
+    return PICKPLAZ_BUTTON_NONE;
+}
+
+#ifdef HAL_SELFTEST
+typedef struct {
+    int64_t time_us;
+    bool active;
+} pickplaz_button_sample_t;
+
+/** Tactile switch, ~1.5 ms of press bounce and ~1 ms of release bounce. */
+static const pickplaz_button_sample_t pickplaz_button_wave_short[] = {
+    { 10000, true }, { 10180, false }, { 10420, true }, { 10510, false },
+    { 10900, true }, { 11050, false }, { 11480, true },
+    { 92000, false }, { 92140, true }, { 92300, false }, { 92760, true },
+    { 92810, false },
+};
+
+/** A 250 us interference spike: must not produce a press. */
+static const pickplaz_button_sample_t pickplaz_button_wave_glitch[] = {
+    { 5000, true }, { 5250, false },
+};
+
+/** Same switch held for 650 ms. */
+static const pickplaz_button_sample_t pickplaz_button_wave_long[] = {
+    { 3000, true }, { 3210, false }, { 3600, true },
+    { 653600, false }, { 653900, true }, { 654100, false },
+};
+
+/**
+ * @brief Replays a recorded waveform through the debouncer with 1 ms polls.
+ *
+ * @param wave Edge samples in time order.
+ * @param count Number of samples.
+ * @param end_us Replay end time.
+ * @param counts Per-event counters indexed by pickplaz_button_event_t.
+ * @return Final button state.
+ */
+static pickplaz_button_t pickplaz_button_replay(const pickplaz_button_sample_t *wave, size_t count,
+                                                int64_t end_us, uint32_t counts[4]) {
+    static const pickplaz_button_config_t config = {
+        .attack_us = 5000,
+        .release_us = 5000,
+        .long_us = 400000,
+    };
+    pickplaz_button_t button;
+    pickplaz_button_init(&button, &config, false, 0);
+    size_t next = 0;
+    for (int64_t now_us = 0; now_us <= end_us; now_us += 1000) {
+        while (next < count && wave[next].time_us <= now_us) {
+            pickplaz_button_edge(&button, wave[next].active, wave[next].time_us);
+            next++;
+        }
+        counts[pickplaz_button_poll(&button, now_us)]++;
+    }
+    return button;
+}
+
+/**
+ * @brief Checks the debouncer against recorded bounce waveforms.
+ *
+ * @details
+ * A bouncing short press must yield exactly one SHORT, a sub-window spike
+ * nothing, and a 650 ms press HOLD events followed by one LONG, with every
+ * event delivered within one poll period of becoming decidable.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_button_selftest(void) {
+    uint32_t counts[4] = {0};
+    bool ok = true;
+
+    pickplaz_button_t button = pickplaz_button_replay(
+        pickplaz_button_wave_short,
+        sizeof(pickplaz_button_wave_short) / sizeof(pickplaz_button_wave_short[0]),
+        200000, counts);
+    ok = ok && counts[PICKPLAZ_BUTTON_SHORT] == 1 && counts[PICKPLAZ_BUTTON_LONG] == 0 &&
+         counts[PICKPLAZ_BUTTON_HOLD] == 0 && button.latency_max_us < 1000 &&
+         !pickplaz_button_busy(&button);
+
+    uint32_t glitch_counts[4] = {0};
+    button = pickplaz_button_replay(
+        pickplaz_button_wave_glitch,
+        sizeof(pickplaz_button_wave_glitch) / sizeof(pickplaz_button_wave_glitch[0]),
+        50000, glitch_counts);
+    ok = ok && button.events == 0 && !pickplaz_button_busy(&button);
+
+    uint32_t long_counts[4] = {0};
+    button = pickplaz_button_replay(
+        pickplaz_button_wave_long,
+        sizeof(pickplaz_button_wave_long) / sizeof(pickplaz_button_wave_long[0]),
+        800000, long_counts);
+    ok = ok && long_counts[PICKPLAZ_BUTTON_LONG] == 1 && long_counts[PICKPLAZ_BUTTON_SHORT] == 0 &&
+         long_counts[PICKPLAZ_BUTTON_HOLD] >= 240 && long_counts[PICKPLAZ_BUTTON_HOLD] <= 260 &&
+         button.latency_max_us < 1000;
+    return ok;
+}
+#endif
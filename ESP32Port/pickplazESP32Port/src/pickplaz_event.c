@@ -0,0 +1,141 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_event.c
+ * @brief Lock-free single-producer/single-consumer event ring.
+ *
+ * @details
+ * Same scheme as the HAL edge ring: free-running head and tail counters
+ * masked into a power-of-two array. Only the producer advances head, with a
+ * release store after the slot is written; only the consumer advances tail,
+ * with a release store after the slot is read. Neither side takes a lock,
+ * so one ring may be shared between exactly one producer context and one
+ * consumer context. A full ring refuses the post and counts a drop rather
+ * than overwriting an unread event.
+ *
+ * Thread-safety:
+ * - One producer and one consumer per ring; contexts with several
+ *   producers use one ring each.
+ */
+
+#include "pickplaz_event.h"
+
+#include <stddef.h>
+
+#define PICKPLAZ_EVENT_MASK (PICKPLAZ_EVENT_RING_LEN - 1U)
+
+_Static_assert((PICKPLAZ_EVENT_RING_LEN & PICKPLAZ_EVENT_MASK) == 0,
+               "PICKPLAZ_EVENT_RING_LEN must be a power of two");
+
+/**
+ * @brief Empties a ring and clears its counters.
+ *
+ * Preconditions:
+ * - Neither the producer nor the consumer is using the ring.
+ *
+ * @param ring Ring state. Must not be NULL.
+ */
+void pickplaz_event_init(pickplaz_event_ring_t *ring) {
+    *ring = (pickplaz_event_ring_t){ 0 };
+}
+
+/**
+ * @brief Posts one event; producer side.
+ *
+ * @param ring Ring state. Must not be NULL.
+ * @param event Event to copy. Must not be NULL.
+ * @return True if queued, false if the ring was full and a drop was counted.
+ */
+bool pickplaz_event_post(pickplaz_event_ring_t *ring, const pickplaz_event_t *event) {
+    uint32_t head = ring->head;
+    uint32_t pending = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (pending >= PICKPLAZ_EVENT_RING_LEN) {
+        ring->dropped++;
+        return false;
+    }
+    ring->slots[head & PICKPLAZ_EVENT_MASK] = *event;
+    __atomic_store_n(&ring->head, head + 1U, __ATOMIC_RELEASE);
+    if (pending + 1U > ring->high_water) {
+        ring->high_water = pending + 1U;
+    }
+    return true;
+}
+
+/**
+ * @brief Removes the oldest event; consumer side.
+ *
+ * @param ring Ring state. Must not be NULL.
+ * @param event Output event. Must not be NULL.
+ * @return True if an event was returned, false if the ring is empty.
+ */
+bool pickplaz_event_take(pickplaz_event_ring_t *ring, pickplaz_event_t *event) {
+    uint32_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    *event = ring->slots[tail & PICKPLAZ_EVENT_MASK];
+    __atomic_store_n(&ring->tail, tail + 1U, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Returns the number of queued events.
+ *
+ * @details
+ * Exact from the consumer; from any other context it is a snapshot that
+ * may already be stale.
+ *
+ * @param ring Ring state. Must not be NULL.
+ * @return Events posted and not yet taken.
+ */
+uint32_t pickplaz_event_pending(const pickplaz_event_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Checks FIFO order, overflow, and counter wrap-around.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_event_selftest(void) {
+    pickplaz_event_ring_t ring;
+    pickplaz_event_t event = { .type = PICKPLAZ_EVENT_COMMAND };
+    pickplaz_event_t out;
+    bool ok = true;
+
+    pickplaz_event_init(&ring);
+    ok = ok && !pickplaz_event_take(&ring, &out) && pickplaz_event_pending(&ring) == 0;
+    for (uint16_t i = 0; i <= PICKPLAZ_EVENT_RING_LEN; i++) {
+        event.arg = i;
+        ok = ok && pickplaz_event_post(&ring, &event) == (i < PICKPLAZ_EVENT_RING_LEN);
+    }
+    ok = ok && ring.dropped == 1 && ring.high_water == PICKPLAZ_EVENT_RING_LEN;
+    for (uint16_t i = 0; i < PICKPLAZ_EVENT_RING_LEN; i++) {
+        ok = ok && pickplaz_event_take(&ring, &out) && out.arg == i &&
+             out.type == PICKPLAZ_EVENT_COMMAND;
+    }
+    ok = ok && !pickplaz_event_take(&ring, &out);
+
+    /* Free-running counters stay correct across the 32-bit wrap. */
+    ring.head = ring.tail = UINT32_MAX - 2U;
+    for (uint16_t i = 0; i < 6; i++) {
+        event.arg = (uint16_t)(100U + i);
+        ok = ok && pickplaz_event_post(&ring, &event);
+    }
+    ok = ok && pickplaz_event_pending(&ring) == 6;
+    for (uint16_t i = 0; i < 6; i++) {
+        ok = ok && pickplaz_event_take(&ring, &out) && out.arg == 100U + i;
+    }
+    ok = ok && pickplaz_event_pending(&ring) == 0 && ring.dropped == 1;
+    return ok;
+}
+#endif
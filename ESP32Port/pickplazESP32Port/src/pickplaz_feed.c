@@ -0,0 +1,212 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_feed.c
+ * @brief Feed-wire pulse decoder working on edge timestamps.
+ *
+ * @details
+ * Measures feed pulse widths from rising/falling edge timestamps instead of
+ * counting ticks, so classification no longer depends on where a pulse
+ * falls relative to the tick. Pulses are grouped into bursts: every pulse
+ * in a burst adds one pocket, and the pulse width class selects direction
+ * (short = forward, long = backward). A single pulse decodes exactly like
+ * the original STM32 short/long feed signal.
+ *
+ * Thread-safety:
+ * - Not thread-safe; feed and poll a decoder from one context.
+ */
+
+#include "pickplaz_feed.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Initializes a decoder at a known input level.
+ *
+ * @details
+ * An input already active at init is treated as a pulse that started at
+ * now_us.
+ *
+ * @param decoder Decoder state. Must not be NULL.
+ * @param config Thresholds, copied. Must not be NULL.
+ * @param active Current input level, true when asserted.
+ * @param now_us Current time in microseconds.
+ */
+void pickplaz_feed_init(pickplaz_feed_decoder_t *decoder, const pickplaz_feed_config_t *config,
+                        bool active, int64_t now_us) {
+    *decoder = (pickplaz_feed_decoder_t){0};
+    decoder->config = *config;
+    decoder->level = active;
+    decoder->rise_us = now_us;
+}
+
+/**
+ * @brief Records a feed input edge and classifies completed pulses.
+ *
+ * @details
+ * Edges that repeat the current level are ignored. A pulse shorter than
+ * min_us is dropped without ending the burst; a pulse longer than max_us
+ * discards the burst in progress.
+ *
+ * @param decoder Decoder state. Must not be NULL.
+ * @param active Input level after the edge, true when asserted.
+ * @param time_us Edge timestamp in microseconds.
+ */
+void pickplaz_feed_edge(pickplaz_feed_decoder_t *decoder, bool active, int64_t time_us) {
+    if (active == decoder->level) {
+        return;
+    }
+    decoder->level = active;
+    if (active) {
+        decoder->rise_us = time_us;
+        return;
+    }
+
+    int64_t width = time_us - decoder->rise_us;
+    if (width < (int64_t)decoder->config.min_us) {
+        decoder->glitches++;
+        return;
+    }
+    if (width > (int64_t)decoder->config.max_us) {
+        decoder->in_burst = false;
+        decoder->rejected++;
+        return;
+    }
+
+    bool forward = width < (int64_t)decoder->config.long_us;
+    if (!decoder->in_burst) {
+        decoder->in_burst = true;
+        decoder->burst_forward = forward;
+        decoder->burst_mixed = false;
+        decoder->pulses = 0;
+    } else if (forward != decoder->burst_forward) {
+        decoder->burst_mixed = true;
+    }
+    decoder->pulses++;
+    decoder->width_us = (uint32_t)width;
+    decoder->fall_us = time_us;
+}
+
+/**
+ * @brief Reports whether the decoder has a burst waiting to complete.
+ *
+ * @param decoder Decoder state. Must not be NULL.
+ * @return True while a burst is waiting for its closing gap.
+ */
+bool pickplaz_feed_busy(const pickplaz_feed_decoder_t *decoder) {
+    return decoder->in_burst;
+}
+
+/**
+ * @brief Completes a burst once the input has been idle for gap_us.
+ *
+ * @details
+ * A pulse that starts within gap_us of the previous falling edge extends the
+ * burst. Bursts mixing short and long pulses are ambiguous and rejected.
+ *
+ * @param decoder Decoder state. Must not be NULL.
+ * @param now_us Current time in microseconds.
+ * @param cmd Output command. Must not be NULL.
+ * @return True when cmd holds a newly decoded command.
+ */
+bool pickplaz_feed_poll(pickplaz_feed_decoder_t *decoder, int64_t now_us,
+                        pickplaz_feed_cmd_t *cmd) {
+    if (!decoder->in_burst || decoder->level) {
+        return false;
+    }
+    if (now_us - decoder->fall_us < (int64_t)decoder->config.gap_us) {
+        return false;
+    }
+    decoder->in_burst = false;
+    if (decoder->burst_mixed) {
+        decoder->rejected++;
+        return false;
+    }
+    cmd->forward = decoder->burst_forward;
+    cmd->pockets = decoder->pulses;
+    cmd->width_us = decoder->width_us;
+    cmd->end_us = decoder->fall_us;
+    decoder->commands++;
+    return true;
+}
+
+#ifdef HAL_SELFTEST
+typedef struct {
+    int64_t time_us;
+    bool active;
+} pickplaz_feed_sample_t;
+
+/**
+ * @brief Replays edges through a decoder with 1 ms polls.
+ *
+ * @param wave Edge samples in time order.
+ * @param count Number of samples.
+ * @param cmds Output commands.
+ * @param max_cmds Capacity of cmds.
+ * @param decoder Decoder to drive, already initialized.
+ * @return Number of commands decoded.
+ */
+static size_t pickplaz_feed_replay(const pickplaz_feed_sample_t *wave, size_t count,
+                                   pickplaz_feed_cmd_t *cmds, size_t max_cmds,
+                                   pickplaz_feed_decoder_t *decoder) {
+    size_t decoded = 0;
+    size_t next = 0;
+    int64_t end_us = wave[count - 1].time_us + 20000;
+    for (int64_t now_us = 0; now_us <= end_us; now_us += 1000) {
+        while (next < count && wave[next].time_us <= now_us) {
+            pickplaz_feed_edge(decoder, wave[next].active, wave[next].time_us);
+            next++;
+        }
+        if (decoded < max_cmds && pickplaz_feed_poll(decoder, now_us, &cmds[decoded])) {
+            decoded++;
+        }
+    }
+    return decoded;
+}
+
+/**
+ * @brief Checks pulse classification and burst decoding.
+ *
+ * @details
+ * Covers a 10.9 ms pulse straddling tick boundaries (short), an 11.2 ms
+ * pulse (long), a three-pulse forward burst with a glitch inside it, and a
+ * mixed burst that must be rejected.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_feed_selftest(void) {
+    static const pickplaz_feed_config_t config = {
+        .min_us = 100,
+        .long_us = 11000,
+        .max_us = 500000,
+        .gap_us = 5000,
+    };
+    static const pickplaz_feed_sample_t wave[] = {
+        { 1950, true }, { 12850, false },                     /* short, 10.9 ms */
+        { 40100, true }, { 51300, false },                    /* long, 11.2 ms */
+        { 80000, true }, { 82000, false }, { 84000, true }, { 86000, false },
+        { 87000, true }, { 87040, false },                    /* glitch in burst */
+        { 88000, true }, { 90000, false },                    /* 3 forward pockets */
+        { 120000, true }, { 122000, false }, { 124000, true }, { 136000, false },
+    };
+    pickplaz_feed_decoder_t decoder;
+    pickplaz_feed_cmd_t cmds[4];
+
+    pickplaz_feed_init(&decoder, &config, false, 0);
+    size_t n = pickplaz_feed_replay(wave, sizeof(wave) / sizeof(wave[0]), cmds, 4, &decoder);
+
+    bool ok = n == 3;
+    ok = ok && cmds[0].forward && cmds[0].pockets == 1 && cmds[0].width_us == 10900;
+    ok = ok && !cmds[1].forward && cmds[1].pockets == 1 && cmds[1].width_us == 11200;
+    ok = ok && cmds[2].forward && cmds[2].pockets == 3;
+    ok = ok && decoder.glitches == 1 && decoder.rejected == 1;
+    return ok;
+}
+#endif
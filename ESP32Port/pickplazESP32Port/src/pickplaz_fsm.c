@@ -0,0 +1,209 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_fsm.c
+ * @brief Table-driven finite state machine engine.
+ *
+ * @details
+ * States, guards, actions, and timeouts live in a const table indexed by
+ * state, so a step costs one table lookup plus the current state's own
+ * transitions, whatever the number of states. Each state has entry, exit,
+ * and dwell hooks, and the engine keeps per-state dwell statistics in a
+ * caller-supplied array. A transition may load its own timer value when the
+ * same state is reached along paths that have already used part of the
+ * timeout.
+ *
+ * Thread-safety:
+ * - Not thread-safe; step an instance from one context.
+ */
+
+#include "pickplaz_fsm.h"
+
+static void pickplaz_fsm_enter(pickplaz_fsm_t *fsm, uint8_t state, uint16_t timer) {
+    const pickplaz_fsm_state_t *next = &fsm->states[state];
+    fsm->state = state;
+    fsm->timer = timer ? timer : next->timeout;
+    fsm->dwell = 0;
+    if (fsm->stats != NULL) {
+        fsm->stats[state].entries++;
+    }
+    if (next->entry != NULL) {
+        next->entry(fsm->ctx);
+    }
+}
+
+static void pickplaz_fsm_fire(pickplaz_fsm_t *fsm, const pickplaz_fsm_transition_t *transition) {
+    const pickplaz_fsm_state_t *current = &fsm->states[fsm->state];
+    if (fsm->stats != NULL) {
+        pickplaz_fsm_stats_t *stats = &fsm->stats[fsm->state];
+        stats->last = fsm->dwell;
+        if (fsm->dwell > stats->max) {
+            stats->max = fsm->dwell;
+        }
+    }
+    if (current->exit != NULL) {
+        current->exit(fsm->ctx);
+    }
+    if (transition->action != NULL) {
+        transition->action(fsm->ctx);
+    }
+    pickplaz_fsm_enter(fsm, transition->target, transition->timer);
+}
+
+/**
+ * @brief Initializes an instance and enters its initial state.
+ *
+ * @param fsm Instance state. Must not be NULL.
+ * @param states State table, indexed by state. Must outlive the instance.
+ * @param count Number of states.
+ * @param initial Starting state, also used to recover from a corrupt state.
+ * @param stats count statistics entries, cleared here, or NULL.
+ * @param ctx Passed to every guard and action.
+ */
+void pickplaz_fsm_init(pickplaz_fsm_t *fsm, const pickplaz_fsm_state_t *states, uint8_t count,
+                       uint8_t initial, pickplaz_fsm_stats_t *stats, void *ctx) {
+    *fsm = (pickplaz_fsm_t){
+        .states = states,
+        .count = count,
+        .initial = initial,
+        .stats = stats,
+        .ctx = ctx,
+    };
+    if (stats != NULL) {
+        for (uint8_t i = 0; i < count; i++) {
+            stats[i] = (pickplaz_fsm_stats_t){ 0 };
+        }
+    }
+    pickplaz_fsm_enter(fsm, initial, 0);
+}
+
+/**
+ * @brief Runs one step: dwell, then at most one transition.
+ *
+ * @param fsm Instance state. Must not be NULL.
+ */
+void pickplaz_fsm_step(pickplaz_fsm_t *fsm) {
+    if (fsm->state >= fsm->count) {
+        pickplaz_fsm_enter(fsm, fsm->initial, 0);
+    }
+    const pickplaz_fsm_state_t *current = &fsm->states[fsm->state];
+    fsm->dwell++;
+    if (fsm->stats != NULL) {
+        fsm->stats[fsm->state].steps++;
+    }
+    if (current->dwell != NULL) {
+        current->dwell(fsm->ctx);
+    }
+
+    for (uint8_t i = 0; i < current->transition_count; i++) {
+        const pickplaz_fsm_transition_t *transition = &current->transitions[i];
+        if (transition->guard == NULL || transition->guard(fsm->ctx)) {
+            pickplaz_fsm_fire(fsm, transition);
+            return;
+        }
+    }
+
+    if (current->timeout != 0) {
+        if (fsm->timer != 0) {
+            fsm->timer--;
+        } else {
+            pickplaz_fsm_fire(fsm, &current->on_timeout);
+        }
+    }
+}
+
+#ifdef HAL_SELFTEST
+typedef struct {
+    bool go;
+    uint32_t entries;
+    uint32_t exits;
+    uint32_t dwells;
+    uint32_t actions;
+} pickplaz_fsm_test_ctx_t;
+
+static bool pickplaz_fsm_test_go(void *ctx) {
+    return ((pickplaz_fsm_test_ctx_t *)ctx)->go;
+}
+
+static void pickplaz_fsm_test_entry(void *ctx) {
+    ((pickplaz_fsm_test_ctx_t *)ctx)->entries++;
+}
+
+static void pickplaz_fsm_test_exit(void *ctx) {
+    ((pickplaz_fsm_test_ctx_t *)ctx)->exits++;
+}
+
+static void pickplaz_fsm_test_dwell(void *ctx) {
+    ((pickplaz_fsm_test_ctx_t *)ctx)->dwells++;
+}
+
+static void pickplaz_fsm_test_action(void *ctx) {
+    ((pickplaz_fsm_test_ctx_t *)ctx)->actions++;
+}
+
+/**
+ * @brief Checks hook order, guards, timeouts, and dwell statistics.
+ *
+ * @details
+ * A two-state table: idle waits for a guard, busy returns on a 3-step
+ * timeout or, when entered through the shortcut transition, a 1-step one.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_fsm_selftest(void) {
+    enum { IDLE, BUSY, COUNT };
+    static const pickplaz_fsm_transition_t idle_out[] = {
+        { .guard = pickplaz_fsm_test_go, .action = pickplaz_fsm_test_action, .target = BUSY },
+    };
+    static const pickplaz_fsm_state_t states[COUNT] = {
+        [IDLE] = { .name = "idle", .transitions = idle_out, .transition_count = 1 },
+        [BUSY] = {
+            .name = "busy",
+            .entry = pickplaz_fsm_test_entry,
+            .exit = pickplaz_fsm_test_exit,
+            .dwell = pickplaz_fsm_test_dwell,
+            .timeout = 3,
+            .on_timeout = { .target = IDLE },
+        },
+    };
+    pickplaz_fsm_test_ctx_t ctx = { 0 };
+    pickplaz_fsm_stats_t stats[COUNT];
+    pickplaz_fsm_t fsm;
+
+    pickplaz_fsm_init(&fsm, states, COUNT, IDLE, stats, &ctx);
+    pickplaz_fsm_step(&fsm);
+    bool ok = fsm.state == IDLE && stats[IDLE].entries == 1;
+    ctx.go = true;
+    pickplaz_fsm_step(&fsm);
+    ctx.go = false;
+    ok = ok && fsm.state == BUSY && ctx.actions == 1 && ctx.entries == 1 && fsm.timer == 3;
+
+    /* Timer 3 counts down over three steps, the fourth takes the timeout. */
+    for (int i = 0; i < 3; i++) {
+        pickplaz_fsm_step(&fsm);
+    }
+    ok = ok && fsm.state == BUSY && fsm.timer == 0;
+    pickplaz_fsm_step(&fsm);
+    ok = ok && fsm.state == IDLE && ctx.exits == 1 && ctx.dwells == 4;
+    ok = ok && stats[BUSY].entries == 1 && stats[BUSY].steps == 4 && stats[BUSY].max == 4;
+    ok = ok && stats[IDLE].last == 2 && stats[IDLE].steps == 2;
+
+    static const pickplaz_fsm_transition_t shortcut = { .target = BUSY, .timer = 1 };
+    pickplaz_fsm_fire(&fsm, &shortcut);
+    pickplaz_fsm_step(&fsm);
+    pickplaz_fsm_step(&fsm);
+    ok = ok && fsm.state == IDLE && stats[BUSY].last == 2 && stats[BUSY].max == 4;
+
+    fsm.state = COUNT;
+    pickplaz_fsm_step(&fsm);
+    ok = ok && fsm.state == IDLE;
+    return ok;
+}
+#endif
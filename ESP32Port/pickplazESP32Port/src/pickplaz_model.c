@@ -0,0 +1,182 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_model.c
+ * @brief Learned mean and variance of a move duration.
+ *
+ * @details
+ * A calibration run feeds durations through Welford's algorithm, which
+ * gives the exact sample mean and variance without storing the samples.
+ * Production moves then update the same model with an exponential moving
+ * average of the mean and of the squared deviation, so it follows wear and
+ * tape changes while forgetting old behaviour at a fixed rate. A timeout is
+ * the mean plus sigma_k standard deviations plus a fixed margin, never
+ * longer than the fixed timeout it replaces. All arithmetic is integer.
+ *
+ * Thread-safety:
+ * - Not thread-safe; update and read a model from one context.
+ */
+
+#include "pickplaz_model.h"
+
+#define PICKPLAZ_MODEL_Q 8
+
+static uint32_t pickplaz_model_isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Clears a model to no samples.
+ *
+ * @param model Model state. Must not be NULL.
+ */
+void pickplaz_model_reset(pickplaz_model_t *model) {
+    *model = (pickplaz_model_t){ 0 };
+}
+
+/**
+ * @brief Adds one measured duration.
+ *
+ * @details
+ * Exact updates, and every update until min_samples have been taken, use
+ * Welford's algorithm; later ones use the moving average.
+ *
+ * @param model Model state. Must not be NULL.
+ * @param config Tuning. Must not be NULL.
+ * @param steps Measured duration.
+ * @param exact True while calibrating.
+ */
+void pickplaz_model_sample(pickplaz_model_t *model, const pickplaz_model_config_t *config,
+                           uint32_t steps, bool exact) {
+    int32_t x_q = (int32_t)(steps << PICKPLAZ_MODEL_Q);
+    int64_t delta = (int64_t)x_q - model->mean_q;
+    model->samples++;
+    if (exact || model->samples <= config->min_samples) {
+        model->mean_q += (int32_t)(delta / (int64_t)model->samples);
+        int64_t delta2 = (int64_t)x_q - model->mean_q;
+        model->m2_q += delta * delta2;
+        if (model->m2_q < 0) {
+            model->m2_q = 0;
+        }
+        model->var_q = model->samples > 1 ? model->m2_q / (int64_t)(model->samples - 1U) : 0;
+        return;
+    }
+    int64_t weight = 1LL << config->ema_shift;
+    model->mean_q += (int32_t)(delta / weight);
+    model->var_q += (delta * delta - model->var_q) / weight;
+}
+
+/**
+ * @brief Returns the mean duration, rounded to whole steps.
+ *
+ * @param model Model state. Must not be NULL.
+ * @return Mean in steps.
+ */
+uint32_t pickplaz_model_mean(const pickplaz_model_t *model) {
+    return (uint32_t)(model->mean_q + (1 << (PICKPLAZ_MODEL_Q - 1))) >> PICKPLAZ_MODEL_Q;
+}
+
+/**
+ * @brief Returns the standard deviation, rounded down to whole steps.
+ *
+ * @param model Model state. Must not be NULL.
+ * @return Standard deviation in steps.
+ */
+uint32_t pickplaz_model_sigma(const pickplaz_model_t *model) {
+    return pickplaz_model_isqrt((uint64_t)model->var_q) >> PICKPLAZ_MODEL_Q;
+}
+
+/**
+ * @brief Reports whether a model has enough samples to be used.
+ *
+ * @param model Model state. Must not be NULL.
+ * @param config Tuning. Must not be NULL.
+ * @return True once min_samples durations have been added.
+ */
+bool pickplaz_model_ready(const pickplaz_model_t *model, const pickplaz_model_config_t *config) {
+    return model->samples >= config->min_samples && model->samples != 0;
+}
+
+/**
+ * @brief Derives a timeout from the model.
+ *
+ * @param model Model state. Must not be NULL.
+ * @param config Tuning. Must not be NULL.
+ * @param fallback Fixed timeout, used until the model is ready and as the
+ *        upper bound afterwards.
+ * @return Timeout in steps.
+ */
+uint32_t pickplaz_model_timeout(const pickplaz_model_t *model,
+                                const pickplaz_model_config_t *config, uint32_t fallback) {
+    if (!pickplaz_model_ready(model, config)) {
+        return fallback;
+    }
+    uint64_t sigma_q = pickplaz_model_isqrt((uint64_t)model->var_q);
+    uint64_t timeout_q = (uint64_t)model->mean_q + config->sigma_k * sigma_q;
+    uint64_t timeout = ((timeout_q + (1U << PICKPLAZ_MODEL_Q) - 1U) >> PICKPLAZ_MODEL_Q) +
+                       config->margin;
+    return timeout < fallback ? (uint32_t)timeout : fallback;
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Checks the exact statistics, the moving average, and timeouts.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_model_selftest(void) {
+    static const pickplaz_model_config_t config = {
+        .sigma_k = 4,
+        .margin = 10,
+        .ema_shift = 2,
+        .min_samples = 4,
+    };
+    static const uint32_t samples[] = { 100, 110, 90, 100, 105, 95 };
+    pickplaz_model_t model;
+    bool ok = true;
+
+    pickplaz_model_reset(&model);
+    ok = ok && !pickplaz_model_ready(&model, &config) &&
+         pickplaz_model_timeout(&model, &config, 500) == 500;
+
+    /* Sample variance of the six durations is 50, sigma 7.07. */
+    for (unsigned i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        pickplaz_model_sample(&model, &config, samples[i], true);
+    }
+    ok = ok && pickplaz_model_mean(&model) == 100 && model.var_q >> 16 == 50 &&
+         pickplaz_model_sigma(&model) == 7;
+    ok = ok && pickplaz_model_timeout(&model, &config, 500) == 139;
+    ok = ok && pickplaz_model_timeout(&model, &config, 120) == 120;
+
+    /* Online updates track a slower feeder at a quarter per sample. */
+    pickplaz_model_sample(&model, &config, 140, false);
+    ok = ok && pickplaz_model_mean(&model) == 110;
+    for (int i = 0; i < 40; i++) {
+        pickplaz_model_sample(&model, &config, 140, false);
+    }
+    ok = ok && pickplaz_model_mean(&model) == 140 && pickplaz_model_sigma(&model) <= 1;
+    ok = ok && pickplaz_model_timeout(&model, &config, 500) <= 155;
+    return ok;
+}
+#endif
@@ -0,0 +1,323 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_profile.c
+ * @brief Fixed-point motion profile between the application FSM and the motor.
+ *
+ * @details
+ * Shapes the signed duty requested by the application into an S-curve (or,
+ * with jerk 0, a trapezoid): a start duty to break static friction, a jerk-
+ * and slew-limited ramp to the cruise duty, and a slower approach duty over
+ * the final part of an indexed move. Without an encoder the approach is
+ * placed on a position proxy, the commanded duty summed over the move,
+ * learned from the previous completed move; a time predictor uses the
+ * previous move's duration instead. Moves that run through their index into
+ * the next pocket are tracked, and may be learned, without an approach. A
+ * request of zero or a direction change is passed through at once: stopping
+ * belongs to the motor FSM brake and the opto cut, which must not be
+ * delayed by a ramp. All per-tick arithmetic is integer.
+ *
+ * Thread-safety:
+ * - Not thread-safe; step a profile from one context.
+ */
+
+#include "pickplaz_profile.h"
+
+#define PICKPLAZ_PROFILE_Q 16
+
+static int32_t pickplaz_profile_per_tick(uint64_t rate, uint64_t ticks) {
+    if (rate == 0) {
+        return 0;
+    }
+    uint64_t q = (rate << PICKPLAZ_PROFILE_Q) / ticks;
+    if (q > INT32_MAX) {
+        return INT32_MAX;
+    }
+    return q == 0 ? 1 : (int32_t)q;
+}
+
+/**
+ * @brief Initializes a profile at rest.
+ *
+ * @param profile Profile state. Must not be NULL.
+ * @param config Limits, copied. Must not be NULL.
+ * @param tick_hz Rate at which pickplaz_profile_step() is called.
+ */
+void pickplaz_profile_init(pickplaz_profile_t *profile, const pickplaz_profile_config_t *config,
+                           uint32_t tick_hz) {
+    *profile = (pickplaz_profile_t){0};
+    profile->config = *config;
+    profile->accel_q = pickplaz_profile_per_tick(config->accel, tick_hz);
+    profile->jerk_q = pickplaz_profile_per_tick(config->jerk, (uint64_t)tick_hz * tick_hz);
+}
+
+/**
+ * @brief Moves the duty one tick towards goal_q within the slew limits.
+ *
+ * @details
+ * With a jerk limit the slew grows by jerk_q per tick up to accel_q and
+ * starts shrinking once the remaining error is within the distance needed
+ * to bring the slew back to zero, so the duty settles on the goal without
+ * overshoot.
+ *
+ * @param profile Profile state.
+ * @param goal_q Target duty magnitude, Q16.
+ */
+static void pickplaz_profile_slew(pickplaz_profile_t *profile, int32_t goal_q) {
+    int32_t err = goal_q - profile->duty_q;
+    if (profile->accel_q == 0) {
+        profile->duty_q = goal_q;
+        profile->slew_q = 0;
+        return;
+    }
+    if (err == 0 && profile->slew_q == 0) {
+        return;
+    }
+
+    int32_t sign = (err >= 0) ? 1 : -1;
+    int32_t slew = profile->slew_q;
+    if (profile->jerk_q == 0) {
+        slew = sign * profile->accel_q;
+    } else {
+        /* Distance covered by this tick plus winding the slew down to zero. */
+        int64_t mag = (int64_t)slew * sign;
+        int64_t jerk = profile->jerk_q;
+        int64_t stop = mag > 0 ? (mag * (mag + jerk)) / (2 * jerk) + mag : 0;
+        if (mag > 0 && (int64_t)err * sign <= stop) {
+            mag -= profile->jerk_q;
+            if (mag < 0) {
+                mag = 0;
+            }
+        } else {
+            mag += profile->jerk_q;
+            if (mag > profile->accel_q) {
+                mag = profile->accel_q;
+            }
+        }
+        slew = (int32_t)mag * sign;
+    }
+
+    int32_t duty = profile->duty_q + slew;
+    if ((goal_q - duty) * (int64_t)sign <= 0) {
+        duty = goal_q;
+        slew = 0;
+    }
+    profile->duty_q = duty;
+    profile->slew_q = slew;
+}
+
+/**
+ * @brief Advances the profile one tick and returns the duty to drive.
+ *
+ * @details
+ * The magnitude of target caps the cruise duty, and the approach duty caps
+ * both once the approach phase has started. Starting from rest applies
+ * start_duty at once and ramps from there.
+ *
+ * @param profile Profile state. Must not be NULL.
+ * @param target Signed duty requested by the application, STM32 units.
+ * @return Signed duty for this tick, STM32 units.
+ */
+int32_t pickplaz_profile_step(pickplaz_profile_t *profile, int32_t target) {
+    int8_t dir = (target > 0) ? 1 : ((target < 0) ? -1 : 0);
+    if (dir == 0 || (profile->dir != 0 && dir != profile->dir)) {
+        profile->dir = 0;
+        profile->duty_q = 0;
+        profile->slew_q = 0;
+        return 0;
+    }
+
+    uint32_t limit = (uint32_t)(target < 0 ? -target : target);
+    if (limit > profile->config.cruise_duty) {
+        limit = profile->config.cruise_duty;
+    }
+    if (profile->approaching && limit > profile->config.approach_duty) {
+        limit = profile->config.approach_duty;
+    }
+    int32_t goal_q = (int32_t)(limit << PICKPLAZ_PROFILE_Q);
+
+    if (profile->dir == 0) {
+        uint32_t start = profile->config.start_duty < limit ? profile->config.start_duty : limit;
+        profile->dir = dir;
+        profile->duty_q = (int32_t)(start << PICKPLAZ_PROFILE_Q);
+        profile->slew_q = 0;
+    } else {
+        pickplaz_profile_slew(profile, goal_q);
+    }
+
+    uint32_t duty = (uint32_t)profile->duty_q >> PICKPLAZ_PROFILE_Q;
+    if (profile->in_move) {
+        profile->progress += duty;
+        profile->ticks++;
+        bool time = profile->config.predictor == PICKPLAZ_PROFILE_PREDICT_TIME;
+        uint32_t done = time ? profile->ticks : profile->progress;
+        uint32_t learned = time ? profile->learned_ticks : profile->learned;
+        if (profile->approach && !profile->approaching && learned != 0 &&
+            profile->config.approach_permille != 0) {
+            uint32_t lead =
+                (uint32_t)(((uint64_t)learned * profile->config.approach_permille) / 1000U);
+            profile->approaching = done + lead >= learned;
+        }
+    }
+    return dir * (int32_t)duty;
+}
+
+/**
+ * @brief Starts tracking a move towards the next index.
+ *
+ * @param profile Profile state. Must not be NULL.
+ * @param approach True when the move stops on the index, false when it
+ *        runs through into the next pocket at cruise duty.
+ */
+void pickplaz_profile_move_begin(pickplaz_profile_t *profile, bool approach) {
+    profile->in_move = true;
+    profile->approach = approach;
+    profile->approaching = false;
+    profile->progress = 0;
+    profile->ticks = 0;
+}
+
+/**
+ * @brief Sets the expected duration of the next move for the time predictor.
+ *
+ * @details
+ * Replaces the duration of the last learned move with an estimate from a
+ * longer history. A later learned move overwrites it again.
+ *
+ * @param profile Profile state. Must not be NULL.
+ * @param ticks Expected move duration, in ticks; 0 disables the approach.
+ */
+void pickplaz_profile_expect(pickplaz_profile_t *profile, uint32_t ticks) {
+    profile->learned_ticks = ticks;
+}
+
+/**
+ * @brief Ends the tracked move.
+ *
+ * @details
+ * Only moves that started at the previous index and reached the next one
+ * describe a full pocket; callers pass learn = false for timeouts and for
+ * moves that started mid-pocket. Learned moves are also timed against an
+ * estimate of the same move at approach duty throughout, the speed a
+ * single-speed move would need to stop on the index.
+ *
+ * @param profile Profile state. Must not be NULL.
+ * @param learn True to use this move to place the next approach phase.
+ */
+void pickplaz_profile_move_end(pickplaz_profile_t *profile, bool learn) {
+    if (profile->in_move && learn && profile->progress != 0) {
+        profile->learned = profile->progress;
+        profile->learned_ticks = profile->ticks;
+        profile->moves++;
+        profile->move_ticks += profile->ticks;
+        if (profile->config.approach_duty != 0) {
+            uint32_t creep = profile->config.approach_duty;
+            profile->creep_ticks += (profile->progress + creep - 1U) / creep;
+        }
+    }
+    profile->in_move = false;
+    profile->approaching = false;
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Checks ramp limits, the approach phase, and stop pass-through.
+ *
+ * @details
+ * Runs an S-curve ramp to cruise checking per-tick slew and jerk bounds,
+ * a trapezoid ramp, a learned move, a run-through move that must hold the
+ * cruise duty, a move that must settle at the approach duty before its
+ * end, an immediate stop and reversal, and the time predictor.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_profile_selftest(void) {
+    static const pickplaz_profile_config_t config = {
+        .cruise_duty = 2048,
+        .approach_duty = 512,
+        .start_duty = 512,
+        .accel = 40000,
+        .jerk = 2000000,
+        .approach_permille = 250,
+    };
+    pickplaz_profile_t profile;
+    bool ok = true;
+
+    pickplaz_profile_init(&profile, &config, 1000);
+    int32_t prev = 0;
+    int32_t prev_delta = 0;
+    uint32_t ticks = 0;
+    for (; ticks < 200 && prev < 2048; ticks++) {
+        int32_t duty = pickplaz_profile_step(&profile, 2048);
+        int32_t delta = duty - prev;
+        if (ticks == 0) {
+            ok = ok && duty == 512;
+        } else {
+            ok = ok && delta >= 0 && delta <= 41 && duty <= 2048;
+            ok = ok && delta - prev_delta <= 3 && prev_delta - delta <= 3;
+            prev_delta = delta;
+        }
+        prev = duty;
+    }
+    ok = ok && prev == 2048 && ticks > 40 && ticks < 100;
+
+    pickplaz_profile_config_t trapezoid = config;
+    trapezoid.jerk = 0;
+    pickplaz_profile_init(&profile, &trapezoid, 1000);
+    pickplaz_profile_step(&profile, 2048);
+    ok = ok && pickplaz_profile_step(&profile, 2048) == 552;
+
+    pickplaz_profile_init(&profile, &config, 1000);
+    pickplaz_profile_move_begin(&profile, true);
+    for (int i = 0; i < 300; i++) {
+        pickplaz_profile_step(&profile, 2048);
+    }
+    pickplaz_profile_move_end(&profile, true);
+    uint32_t learned = profile.learned;
+    pickplaz_profile_step(&profile, 0);
+
+    pickplaz_profile_move_begin(&profile, false);
+    int32_t duty = 0;
+    for (int i = 0; i < 350; i++) {
+        duty = pickplaz_profile_step(&profile, 2048);
+    }
+    ok = ok && !profile.approaching && duty == 2048;
+    pickplaz_profile_move_end(&profile, false);
+    pickplaz_profile_step(&profile, 0);
+
+    pickplaz_profile_move_begin(&profile, true);
+    for (int i = 0; i < 350; i++) {
+        int32_t next = pickplaz_profile_step(&profile, 2048);
+        ok = ok && (!profile.approaching || next <= duty);
+        duty = next;
+    }
+    ok = ok && learned > 500000 && profile.approaching && duty == 512 &&
+         profile.progress < learned;
+    ok = ok && pickplaz_profile_step(&profile, 0) == 0;
+    ok = ok && pickplaz_profile_step(&profile, -2048) == -512;
+    ok = ok && pickplaz_profile_step(&profile, 2048) == 0;
+    ok = ok && profile.moves == 1 && profile.learned_ticks == 300 &&
+         profile.creep_ticks > profile.move_ticks;
+
+    /* The time predictor starts the approach at 75% of the learned 300 ticks. */
+    pickplaz_profile_config_t timed = config;
+    timed.predictor = PICKPLAZ_PROFILE_PREDICT_TIME;
+    pickplaz_profile_init(&profile, &timed, 1000);
+    profile.learned_ticks = 300;
+    pickplaz_profile_move_begin(&profile, true);
+    for (int i = 0; i < 224; i++) {
+        pickplaz_profile_step(&profile, 2048);
+    }
+    ok = ok && !profile.approaching;
+    pickplaz_profile_step(&profile, 2048);
+    ok = ok && profile.approaching;
+    return ok;
+}
+#endif
@@ -0,0 +1,190 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_queue.c
+ * @brief Bounded FIFO of feed requests with coalescing.
+ *
+ * @details
+ * Feed pulses, button presses, and host commands are queued in arrival
+ * order instead of overwriting a single latch. A request in the same
+ * direction as the newest queued one is merged into it, so "+1 forward"
+ * three times becomes "+3 forward" and one slot. The merged request keeps
+ * the oldest timestamp, so queueing latency is measured from the first
+ * request that is still waiting. A request is refused and counted only when
+ * it cannot be merged whole and every slot is taken; a refused request
+ * leaves the queue unchanged.
+ *
+ * Thread-safety:
+ * - Not thread-safe; push and pop from one context.
+ */
+
+#include "pickplaz_queue.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Empties a queue and clears its counters.
+ *
+ * @param queue Queue state. Must not be NULL.
+ */
+void pickplaz_queue_init(pickplaz_queue_t *queue) {
+    *queue = (pickplaz_queue_t){ 0 };
+}
+
+/**
+ * @brief Queues a feed request, merging it into the newest one if possible.
+ *
+ * @details
+ * The newest request is extended while its pocket count fits in 16 bits;
+ * the remainder starts a new slot. A request is taken whole or not at all:
+ * if its remainder would need a slot and none is free, nothing is merged.
+ *
+ * @param queue Queue state. Must not be NULL.
+ * @param forward Feed direction.
+ * @param pockets Pockets to feed; 0 is ignored.
+ * @param now_us Time the request arrived.
+ * @return True if queued or merged, false if the queue was full and a drop
+ *         was counted.
+ */
+bool pickplaz_queue_push(pickplaz_queue_t *queue, bool forward, uint16_t pockets,
+                         int64_t now_us) {
+    if (pockets == 0) {
+        return true;
+    }
+    pickplaz_queue_req_t *tail = NULL;
+    uint16_t merged = 0;
+    if (queue->count != 0) {
+        tail = &queue->slots[(queue->head + queue->count - 1U) % PICKPLAZ_QUEUE_LEN];
+        uint32_t room = tail->forward == forward ? UINT16_MAX - tail->pockets : 0U;
+        merged = pockets > room ? (uint16_t)room : pockets;
+    }
+    if (merged < pockets && queue->count >= PICKPLAZ_QUEUE_LEN) {
+        queue->dropped++;
+        return false;
+    }
+    queue->queued++;
+    if (merged != 0) {
+        tail->pockets = (uint16_t)(tail->pockets + merged);
+        pockets = (uint16_t)(pockets - merged);
+        queue->coalesced++;
+        if (pockets == 0) {
+            return true;
+        }
+    }
+    queue->slots[(queue->head + queue->count) % PICKPLAZ_QUEUE_LEN] = (pickplaz_queue_req_t){
+        .forward = forward,
+        .pockets = pockets,
+        .time_us = now_us,
+    };
+    queue->count++;
+    if (queue->count > queue->high_water) {
+        queue->high_water = queue->count;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the oldest request without removing it.
+ *
+ * @param queue Queue state. Must not be NULL.
+ * @return The oldest request, or NULL when the queue is empty.
+ */
+const pickplaz_queue_req_t *pickplaz_queue_peek(const pickplaz_queue_t *queue) {
+    return queue->count != 0 ? &queue->slots[queue->head] : NULL;
+}
+
+/**
+ * @brief Removes the oldest request.
+ *
+ * @param queue Queue state. Must not be NULL.
+ * @param req Output request, or NULL to discard it.
+ * @return True if a request was removed, false if the queue is empty.
+ */
+bool pickplaz_queue_pop(pickplaz_queue_t *queue, pickplaz_queue_req_t *req) {
+    if (queue->count == 0) {
+        return false;
+    }
+    if (req != NULL) {
+        *req = queue->slots[queue->head];
+    }
+    queue->head = (uint8_t)((queue->head + 1U) % PICKPLAZ_QUEUE_LEN);
+    queue->count--;
+    return true;
+}
+
+/**
+ * @brief Discards every queued request, counting them as flushed.
+ *
+ * @param queue Queue state. Must not be NULL.
+ */
+void pickplaz_queue_flush(pickplaz_queue_t *queue) {
+    queue->flushed += queue->count;
+    queue->count = 0;
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Checks FIFO order, coalescing, overflow, and saturation.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_queue_selftest(void) {
+    pickplaz_queue_t queue;
+    pickplaz_queue_req_t req;
+    bool ok = true;
+
+    pickplaz_queue_init(&queue);
+    ok = ok && pickplaz_queue_peek(&queue) == NULL && !pickplaz_queue_pop(&queue, &req);
+
+    /* Same-direction requests merge and keep the first timestamp. */
+    for (int i = 0; i < 3; i++) {
+        ok = ok && pickplaz_queue_push(&queue, true, 1, 100 + i);
+    }
+    ok = ok && pickplaz_queue_push(&queue, false, 2, 200);
+    ok = ok && pickplaz_queue_push(&queue, true, 1, 300);
+    ok = ok && queue.count == 3 && queue.coalesced == 2 && queue.queued == 5;
+    ok = ok && pickplaz_queue_pop(&queue, &req) && req.forward && req.pockets == 3 &&
+         req.time_us == 100;
+    ok = ok && pickplaz_queue_pop(&queue, &req) && !req.forward && req.pockets == 2;
+    ok = ok && pickplaz_queue_pop(&queue, &req) && req.forward && req.time_us == 300;
+
+    /* Alternating directions fill every slot, then drop. */
+    for (int i = 0; i <= PICKPLAZ_QUEUE_LEN; i++) {
+        ok = ok && pickplaz_queue_push(&queue, (i & 1) != 0, 1, i) == (i < PICKPLAZ_QUEUE_LEN);
+    }
+    ok = ok && queue.dropped == 1 && queue.high_water == PICKPLAZ_QUEUE_LEN;
+    /* A full queue still merges into its newest request. */
+    ok = ok && pickplaz_queue_push(&queue, true, 4, 50) && queue.dropped == 1;
+    for (int i = 0; i < PICKPLAZ_QUEUE_LEN; i++) {
+        ok = ok && pickplaz_queue_pop(&queue, &req) && req.forward == ((i & 1) != 0) &&
+             req.pockets == (i == PICKPLAZ_QUEUE_LEN - 1 ? 5 : 1);
+    }
+
+    /* A saturated request spills into a new slot. */
+    ok = ok && pickplaz_queue_push(&queue, false, UINT16_MAX - 1U, 0);
+    ok = ok && pickplaz_queue_push(&queue, false, 3, 1) && queue.count == 2;
+    ok = ok && pickplaz_queue_peek(&queue)->pockets == UINT16_MAX;
+    pickplaz_queue_flush(&queue);
+    ok = ok && queue.count == 0 && queue.flushed == 2;
+
+    /* A full queue refuses a request whose remainder needs a slot, whole. */
+    for (int i = 0; i < PICKPLAZ_QUEUE_LEN; i++) {
+        ok = ok && pickplaz_queue_push(&queue, (i & 1) != 0, 1, i);
+    }
+    ok = ok && pickplaz_queue_push(&queue, true, UINT16_MAX - 2U, 0);
+    uint32_t queued = queue.queued;
+    uint32_t coalesced = queue.coalesced;
+    ok = ok && !pickplaz_queue_push(&queue, true, 3, 0) && queue.dropped == 2;
+    ok = ok && queue.queued == queued && queue.coalesced == coalesced &&
+         queue.slots[(queue.head + queue.count - 1U) % PICKPLAZ_QUEUE_LEN].pockets ==
+             UINT16_MAX - 1U;
+    return ok;
+}
+#endif
@@ -0,0 +1,276 @@
+/*
+ * PickPlaz ESP32-C3 Port
+ * Copyright (c) 2026 Asterion Daedalus https://github.com/Bazmundi
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of PickPlaz ESP32-C3 Port and is licensed under the MIT License.
+ * See the LICENSE file in the project root for full license text.
+ */
+
+/**
+ * @file pickplaz_speed.c
+ * @brief Closed-loop cruise duty from opto edge timing.
+ *
+ * @details
+ * The opto sees one index per pocket, so tape speed is estimated from the
+ * time between leaving one index and reaching the next: a fixed distance.
+ * Each completed gap updates a fixed-point PI controller whose output is
+ * the cruise duty for the following moves. The error is the relative gap
+ * error in Q10, so gains do not depend on the setpoint. The integrator only
+ * accumulates while the output is not saturated in the same direction
+ * (conditional integration) and is bounded to the duty range. When no opto
+ * edge arrives within timeout_us while driving, the controller falls back
+ * to open_duty until a fresh gap is measured.
+ *
+ * Thread-safety:
+ * - Not thread-safe; feed and query a controller from one context.
+ */
+
+#include "pickplaz_speed.h"
+
+#define PICKPLAZ_SPEED_Q 10
+#define PICKPLAZ_SPEED_ONE (1 << PICKPLAZ_SPEED_Q)
+
+static int32_t pickplaz_speed_clamp(int32_t value, int32_t lo, int32_t hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+/**
+ * @brief Initializes a controller in open loop.
+ *
+ * @param speed Controller state. Must not be NULL.
+ * @param config Tuning, copied. Must not be NULL.
+ */
+void pickplaz_speed_init(pickplaz_speed_t *speed, const pickplaz_speed_config_t *config) {
+    *speed = (pickplaz_speed_t){0};
+    speed->config = *config;
+    speed->duty = config->open_duty;
+}
+
+/**
+ * @brief Records a measured gap and runs one PI update when enabled.
+ *
+ * @param speed Controller state.
+ * @param gap_us Measured gap in microseconds.
+ */
+static void pickplaz_speed_update(pickplaz_speed_t *speed, uint32_t gap_us) {
+    const pickplaz_speed_config_t *cfg = &speed->config;
+    speed->gap_us = gap_us;
+    if (cfg->setpoint_us == 0) {
+        return;
+    }
+    int64_t err = (((int64_t)gap_us - cfg->setpoint_us) * PICKPLAZ_SPEED_ONE) / cfg->setpoint_us;
+    int32_t e = pickplaz_speed_clamp((int32_t)err, -PICKPLAZ_SPEED_ONE, PICKPLAZ_SPEED_ONE);
+    int32_t lo = (int32_t)cfg->min_duty - (int32_t)cfg->open_duty;
+    int32_t hi = (int32_t)cfg->max_duty - (int32_t)cfg->open_duty;
+
+    int32_t p = (int32_t)(((int64_t)cfg->kp * e) / PICKPLAZ_SPEED_ONE);
+    int32_t i = (int32_t)(((int64_t)cfg->ki * e) / PICKPLAZ_SPEED_ONE);
+    int32_t u = p + speed->integ;
+    /* A slow gap (e > 0) must not wind the integrator further into the top rail. */
+    if (!((e > 0 && u >= hi) || (e < 0 && u <= lo))) {
+        speed->integ = pickplaz_speed_clamp(speed->integ + i, lo, hi);
+        u = p + speed->integ;
+    }
+
+    u = pickplaz_speed_clamp(u, lo, hi);
+    speed->duty = (uint32_t)((int32_t)cfg->open_duty + u);
+    speed->closed = true;
+    speed->samples++;
+}
+
+/**
+ * @brief Records an opto level change.
+ *
+ * @details
+ * Leaving the index while driving starts a gap; reaching the next index
+ * while the gap is running completes it. Edges while the motor is idle
+ * cancel the gap, since a stop in between would lengthen it. Gaps are
+ * measured with the loop disabled too, for the brake planner.
+ *
+ * @param speed Controller state. Must not be NULL.
+ * @param indexed Opto level after the edge, true when on an index.
+ * @param time_us Edge timestamp in microseconds.
+ * @param driving True while the motor is being driven.
+ */
+void pickplaz_speed_edge(pickplaz_speed_t *speed, bool indexed, int64_t time_us, bool driving) {
+    if (!driving) {
+        speed->armed = false;
+        return;
+    }
+    speed->edge_us = time_us;
+    if (!indexed) {
+        speed->armed = true;
+        speed->exit_us = time_us;
+        return;
+    }
+    if (!speed->armed) {
+        return;
+    }
+    speed->armed = false;
+    int64_t gap = time_us - speed->exit_us;
+    if (gap > 0 && gap <= (int64_t)speed->config.timeout_us) {
+        speed->arrive_us = time_us;
+        pickplaz_speed_update(speed, (uint32_t)gap);
+    }
+}
+
+/**
+ * @brief Falls back to open loop when opto edges stop arriving.
+ *
+ * @details
+ * Call once per control step. While driving, an edge is expected within
+ * timeout_us of the drive starting or of the previous edge; a stall that
+ * never leaves the index is caught as well as a missed index. A stop
+ * cancels the gap in progress without falling back.
+ *
+ * @param speed Controller state. Must not be NULL.
+ * @param now_us Current time in microseconds.
+ * @param driving True while the motor is being driven.
+ */
+void pickplaz_speed_check(pickplaz_speed_t *speed, int64_t now_us, bool driving) {
+    if (!driving) {
+        speed->driving = false;
+        speed->armed = false;
+        return;
+    }
+    if (!speed->driving) {
+        speed->driving = true;
+        speed->edge_us = now_us;
+    }
+    if (now_us - speed->edge_us <= (int64_t)speed->config.timeout_us) {
+        return;
+    }
+    speed->armed = false;
+    speed->edge_us = now_us;
+    if (speed->closed) {
+        speed->closed = false;
+        speed->integ = 0;
+        speed->duty = speed->config.open_duty;
+        speed->fallbacks++;
+    }
+}
+
+/**
+ * @brief Returns the cruise duty to command.
+ *
+ * @param speed Controller state. Must not be NULL.
+ * @return Duty magnitude in STM32 units; open_duty while in open loop.
+ */
+uint32_t pickplaz_speed_duty(const pickplaz_speed_t *speed) {
+    return speed->duty;
+}
+
+#ifdef HAL_SELFTEST
+/**
+ * @brief Simulated DC motor driving tape past the opto, 1 ms steps.
+ *
+ * @details
+ * Tape position is in um with a 4 mm pocket pitch and a 1 mm index window.
+ * Speed follows duty through a first-order lag (tau 20 ms) with a linear
+ * gain minus a drag term; the motor brakes to rest on reaching an index.
+ */
+typedef struct {
+    int32_t gain;     /**< Steady-state um/s per duty unit. */
+    int32_t drag;     /**< Steady-state speed lost to friction, um/s. */
+    int64_t pos_um;
+    int64_t vel;      /**< Speed, um/s. */
+    int64_t now_us;
+    bool indexed;
+} pickplaz_speed_sim_t;
+
+static bool pickplaz_speed_sim_indexed(int64_t pos_um) {
+    return (pos_um % 4000) < 1000;
+}
+
+/**
+ * @brief Runs one simulated pocket move under the controller.
+ *
+ * @param sim Plant state.
+ * @param speed Controller under test.
+ */
+static void pickplaz_speed_sim_move(pickplaz_speed_sim_t *sim, pickplaz_speed_t *speed) {
+    bool left = false;
+    for (int i = 0; i < 2000; i++) {
+        pickplaz_speed_check(speed, sim->now_us, true);
+        int64_t ss = (int64_t)sim->gain * pickplaz_speed_duty(speed) - sim->drag;
+        if (ss < 0) {
+            ss = 0;
+        }
+        sim->vel += (ss - sim->vel) / 20;
+        sim->pos_um += sim->vel / 1000;
+        sim->now_us += 1000;
+
+        bool indexed = pickplaz_speed_sim_indexed(sim->pos_um);
+        if (indexed != sim->indexed) {
+            sim->indexed = indexed;
+            pickplaz_speed_edge(speed, indexed, sim->now_us, true);
+            if (!indexed) {
+                left = true;
+            } else if (left) {
+                break;
+            }
+        }
+    }
+    sim->vel = 0;
+    sim->now_us += 50000;
+    pickplaz_speed_check(speed, sim->now_us, false);
+}
+
+/**
+ * @brief Checks convergence on mismatched plants, anti-windup, and fallback.
+ *
+ * @details
+ * Two simulated feeders, one fast and one slow at the open-loop duty, must
+ * both settle within 5% of the gap setpoint. A plant too weak to reach the
+ * setpoint must leave the integrator bounded, and a drive without edges
+ * must return the controller to open loop.
+ *
+ * @return True when every check passes.
+ */
+bool pickplaz_speed_selftest(void) {
+    static const pickplaz_speed_config_t config = {
+        .setpoint_us = 150000,
+        .kp = 512,
+        .ki = 256,
+        .min_duty = 256,
+        .max_duty = 2048,
+        .open_duty = 1024,
+        .timeout_us = 600000,
+    };
+    static const int32_t gains[] = { 32, 20 };
+    pickplaz_speed_t speed;
+    bool ok = true;
+
+    for (unsigned p = 0; p < sizeof(gains) / sizeof(gains[0]); p++) {
+        pickplaz_speed_sim_t sim = { .gain = gains[p], .drag = 5000, .pos_um = 4000,
+                                     .indexed = true };
+        pickplaz_speed_init(&speed, &config);
+        pickplaz_speed_sim_move(&sim, &speed);
+        uint32_t open_gap = speed.gap_us;
+        for (int move = 1; move < 30; move++) {
+            pickplaz_speed_sim_move(&sim, &speed);
+        }
+        ok = ok && (open_gap < 142500 || open_gap > 157500);
+        ok = ok && speed.closed && speed.samples == 30 && speed.gap_us >= 142500 &&
+             speed.gap_us <= 157500;
+    }
+
+    pickplaz_speed_sim_t weak = { .gain = 6, .drag = 0, .pos_um = 4000, .indexed = true };
+    pickplaz_speed_init(&speed, &config);
+    for (int move = 0; move < 10; move++) {
+        pickplaz_speed_sim_move(&weak, &speed);
+    }
+    ok = ok && speed.samples == 10 && speed.duty == config.max_duty &&
+         speed.integ <= (int32_t)(config.max_duty - config.open_duty);
+
+    /* Stalled on the index: no edge at all while driving. */
+    pickplaz_speed_check(&speed, weak.now_us, true);
+    pickplaz_speed_check(&speed, weak.now_us + config.timeout_us, true);
+    ok = ok && speed.closed;
+    pickplaz_speed_check(&speed, weak.now_us + config.timeout_us + 1000, true);
+    ok = ok && !speed.closed && speed.fallbacks == 1 && speed.duty == config.open_duty &&
+         speed.integ == 0;
+    return ok;
+}
+#endif